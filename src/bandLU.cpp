@@ -0,0 +1,100 @@
+#include "bandLU.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+BandLU::BandLU(const StructuredMatrix & matrix) : n(matrix.getRows()), kl(matrix.getLowerBandwidth()),
+  ku(matrix.getUpperBandwidth()), width(2 * kl + ku + 1), data(n * width, 0), pivots(n){
+  const vector<double> & a = matrix.getData();
+  double largest = 0;
+  for(size_t i = 0; i < n; ++i){
+    size_t first, last;
+    matrix.rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j){
+      at(i, j) = a[matrix.index(i, j)];
+      largest = max(largest, fabs(at(i, j)));
+    }
+  }
+  double tolerance = largest * n * numeric_limits<double>::epsilon();
+  for(size_t k = 0; k < n; ++k){
+    //rows below the band of the column are zero, rows are swapped only in the band
+    size_t last = min(n, k + kl + 1), end = min(n, k + kl + ku + 1);
+    size_t p = k;
+    for(size_t i = k + 1; i < last; ++i)
+      if(fabs(at(i, k)) > fabs(at(p, k)))
+        p = i;
+    pivots[k] = p;
+    if(fabs(at(p, k)) <= tolerance){
+      //nothing to eliminate, forget rounding residue
+      for(size_t i = k; i < last; ++i)
+        at(i, k) = 0;
+      singular = true;
+      det = 0;
+      continue;
+    }
+    if(p != k){
+      for(size_t j = k; j < end; ++j)
+        swap(at(k, j), at(p, j));
+      det *= -1;
+    }
+    double pivot = at(k, k);
+    det *= pivot;
+    for(size_t i = k + 1; i < last; ++i){
+      double l = (at(i, k) /= pivot);
+      if(l == 0)
+        continue;
+      for(size_t j = k + 1; j < end; ++j)
+        at(i, j) -= l * at(k, j);
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+double & BandLU::at(size_t i, size_t j){
+  return data[i * width + kl + j - i];
+}
+//---------------------------------------------------------------------------------------
+double BandLU::at(size_t i, size_t j) const{
+  return data[i * width + kl + j - i];
+}
+//---------------------------------------------------------------------------------------
+bool BandLU::isSingular() const{
+  return singular;
+}
+//---------------------------------------------------------------------------------------
+double BandLU::getDeterminant() const{
+  return det;
+}
+//---------------------------------------------------------------------------------------
+void BandLU::solve(vector<double> & b, size_t cols) const{
+  //forward substitution, rows are swapped in the same order as during factorization
+  for(size_t k = 0; k < n; ++k){
+    double * bk = &b[k * cols];
+    if(pivots[k] != k)
+      swap_ranges(bk, bk + cols, &b[pivots[k] * cols]);
+    for(size_t i = k + 1; i < min(n, k + kl + 1); ++i){
+      double l = at(i, k);
+      if(l == 0)
+        continue;
+      double * bi = &b[i * cols];
+      for(size_t j = 0; j < cols; ++j)
+        bi[j] -= l * bk[j];
+    }
+  }
+  //back substitution with U which has kl+ku diagonals above the main diagonal
+  for(size_t i = n; i-- > 0;){
+    double * bi = &b[i * cols];
+    for(size_t k = i + 1; k < min(n, i + kl + ku + 1); ++k){
+      double u = at(i, k);
+      if(u == 0)
+        continue;
+      const double * bk = &b[k * cols];
+      for(size_t j = 0; j < cols; ++j)
+        bi[j] -= u * bk[j];
+    }
+    double pivot = at(i, i);
+    for(size_t j = 0; j < cols; ++j)
+      bi[j] /= pivot;
+  }
+}
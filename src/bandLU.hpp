@@ -0,0 +1,55 @@
+#ifndef BANDLU_HPP
+#define BANDLU_HPP
+
+#include <vector>
+#include "factorization.hpp"
+#include "structuredMatrix.hpp"
+
+/**
+  * @brief LU factorization of band matrices with partial pivoting.
+  *
+  * Matrix with <i>kl</i> diagonals below and <i>ku</i> diagonals above the main diagonal
+  * is factored as PA = LU like by LAPACK gbtrf. Pivot of every column is searched only
+  * among <i>kl</i> rows below the diagonal, so U has at most kl+ku diagonals above the
+  * main diagonal and every row of the factors fits to 2kl+ku+1 slots. Memory is
+  * O(n(kl+ku)), factorization costs O(n kl (kl+ku)) and solving one right-hand side
+  * O(n(kl+ku)).
+  */
+class BandLU : public Factorization{
+  private:
+    size_t n, ///< Number of rows and columns.
+           kl, ///< Number of diagonals below the main diagonal.
+           ku, ///< Number of diagonals above the main diagonal.
+           width; ///< Number of slots of one row.
+    std::vector<double> data; ///< Factors L and U, element (i, j) is in slot kl+j-i of <i>i</i>-th row.
+    std::vector<size_t> pivots; ///< Row swapped with <i>i</i>-th row in <i>i</i>-th step.
+    double det = 1; ///< Determinant.
+    bool singular = false; ///< Whether a zero pivot was found.
+
+    /**
+      * @brief Returns reference to the element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column, i - kl <= j <= i + kl + ku
+      * @return element
+      */
+    double & at(size_t i, size_t j);
+    /**
+      * @brief Returns the element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column, i - kl <= j <= i + kl + ku
+      * @return element
+      */
+    double at(size_t i, size_t j) const;
+  public:
+    /**
+      * @brief Factors matrix.
+      * @param matrix matrix, its band is given by StructuredMatrix::getLowerBandwidth and
+      * StructuredMatrix::getUpperBandwidth
+      */
+    BandLU(const StructuredMatrix & matrix);
+    virtual bool isSingular() const;
+    virtual double getDeterminant() const;
+    virtual void solve(std::vector<double> & b, size_t cols) const;
+};
+
+#endif /* BANDLU_HPP */
@@ -0,0 +1,219 @@
+#include "bitMatrix.hpp"
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+const size_t BitMatrix::WORD_BITS = 64;
+const size_t BitMatrix::TABLE_BITS = 8;
+
+BitMatrix::BitMatrix(size_t r, size_t c) : MatrixType(r, c), words((c + WORD_BITS - 1) / WORD_BITS), data(r * words, 0){
+}
+//---------------------------------------------------------------------------------------
+BitMatrix::BitMatrix(const MatrixType & m) : BitMatrix(m.getRows(), m.getCols()){
+  m.forEachNonZero([this](size_t i, size_t j, double x){
+    setValue(i, j, x);
+  });
+}
+//---------------------------------------------------------------------------------------
+uint64_t * BitMatrix::row(size_t i){
+  return data.data() + i * words;
+}
+//---------------------------------------------------------------------------------------
+const uint64_t * BitMatrix::row(size_t i) const{
+  return data.data() + i * words;
+}
+//---------------------------------------------------------------------------------------
+uint64_t BitMatrix::getBits(size_t i, size_t j, size_t k) const{
+  const uint64_t * p = row(i) + j / WORD_BITS;
+  size_t shift = j % WORD_BITS;
+  uint64_t out = p[0] >> shift;
+  if(shift != 0 && shift + k > WORD_BITS)
+    out |= p[1] << (WORD_BITS - shift);
+  return k == WORD_BITS ? out : out & (((uint64_t) 1 << k) - 1);
+}
+//---------------------------------------------------------------------------------------
+size_t BitMatrix::tableBits(size_t n){
+  //table of 2^k rows pays off when it updates several times more rows
+  size_t k = 1;
+  while(k < TABLE_BITS && ((size_t) 4 << k) < n)
+    ++k;
+  return k;
+}
+//---------------------------------------------------------------------------------------
+void BitMatrix::makeTable(const vector<const uint64_t *> & rows, size_t length, vector<uint64_t> & table){
+  size_t size = (size_t) 1 << rows.size();
+  table.assign(size * length, 0);
+  for(size_t t = 1; t < size; ++t){
+    const uint64_t * prev = &table[(t & (t - 1)) * length];
+    const uint64_t * add = rows[__builtin_ctzll(t)];
+    uint64_t * out = &table[t * length];
+    for(size_t w = 0; w < length; ++w)
+      out[w] = prev[w] ^ add[w];
+  }
+}
+//---------------------------------------------------------------------------------------
+size_t BitMatrix::eliminate(size_t cols, bool reduced){
+  size_t rank = 0;
+  size_t k = tableBits(r);
+  vector<uint64_t> table, lookup;
+  vector<const uint64_t *> pivots;
+  vector<size_t> pivotCols;
+  for(size_t col = 0; col < cols && rank < r; col += k){
+    size_t width = min(k, cols - col), start = rank, first = col / WORD_BITS, length = words - first;
+    pivots.clear();
+    pivotCols.clear();
+    //pivots of the block are found one by one, candidates are reduced by pivots found so far
+    for(size_t j = col; j < col + width && rank < r; ++j){
+      size_t p = rank;
+      for(; p < r; ++p){
+        uint64_t * candidate = row(p) + first;
+        for(size_t t = 0; t < pivots.size(); ++t)
+          if(getValue(p, pivotCols[t]) != 0)
+            for(size_t w = 0; w < length; ++w)
+              candidate[w] ^= pivots[t][w];
+        if(getValue(p, j) != 0)
+          break;
+      }
+      if(p == r)
+        continue;
+      swap_ranges(row(p), row(p) + words, row(rank));
+      uint64_t * pivot = row(rank) + first;
+      //block of pivot rows stays identity on pivot columns
+      for(size_t t = 0; t < pivots.size(); ++t)
+        if(getValue(start + t, j) != 0)
+          for(size_t w = 0; w < length; ++w)
+            row(start + t)[first + w] ^= pivot[w];
+      pivots.push_back(pivot);
+      pivotCols.push_back(j);
+      ++rank;
+    }
+    if(pivots.empty())
+      continue;
+    makeTable(pivots, length, table);
+    //bits of the block select the combination of pivot rows which clears them
+    lookup.assign((size_t) 1 << width, 0);
+    for(size_t v = 0; v < lookup.size(); ++v)
+      for(size_t t = 0; t < pivotCols.size(); ++t)
+        if((v >> (pivotCols[t] - col)) & 1)
+          lookup[v] |= (uint64_t) 1 << t;
+    for(size_t i = 0; i < r; ++i){
+      if(i < start ? !reduced : i < rank)
+        continue;
+      uint64_t index = lookup[getBits(i, col, width)];
+      if(index == 0)
+        continue;
+      const uint64_t * add = &table[index * length];
+      uint64_t * out = row(i) + first;
+      for(size_t w = 0; w < length; ++w)
+        out[w] ^= add[w];
+    }
+  }
+  return rank;
+}
+//---------------------------------------------------------------------------------------
+double BitMatrix::getValue(size_t i, size_t j) const{
+  return (row(i)[j / WORD_BITS] >> (j % WORD_BITS)) & 1;
+}
+//---------------------------------------------------------------------------------------
+void BitMatrix::setValue(size_t i, size_t j, double x){
+  if(x != floor(x))
+    throw MatrixException("Matrix is not integral!");
+  uint64_t bit = (uint64_t) 1 << (j % WORD_BITS);
+  if(fmod(x, 2) != 0)
+    row(i)[j / WORD_BITS] |= bit;
+  else
+    row(i)[j / WORD_BITS] &= ~bit;
+}
+//---------------------------------------------------------------------------------------
+void BitMatrix::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  const uint64_t * p = row(i);
+  for(size_t w = 0; w < words; ++w)
+    for(uint64_t bits = p[w]; bits != 0; bits &= bits - 1)
+      visit(w * WORD_BITS + __builtin_ctzll(bits), 1);
+}
+//---------------------------------------------------------------------------------------
+double BitMatrix::getRatioOfZeros() const{
+  size_t ones = 0;
+  for(uint64_t x : data)
+    ones += __builtin_popcountll(x);
+  return (r * c - ones) / (double) (r * c);
+}
+//---------------------------------------------------------------------------------------
+size_t BitMatrix::getMemory() const{
+  return data.size() * sizeof(uint64_t);
+}
+//---------------------------------------------------------------------------------------
+BitMatrix * BitMatrix::add(const BitMatrix & other) const{
+  BitMatrix * out = new BitMatrix(r, c);
+  for(size_t i = 0; i < data.size(); ++i)
+    out->data[i] = data[i] ^ other.data[i];
+  return out;
+}
+//---------------------------------------------------------------------------------------
+BitMatrix * BitMatrix::multiply(const BitMatrix & other) const{
+  BitMatrix * out = new BitMatrix(r, other.c);
+  size_t k = tableBits(r);
+  vector<uint64_t> table;
+  vector<const uint64_t *> rows;
+  //k rows of the other matrix are combined for every block of k columns of this matrix
+  for(size_t col = 0; col < c; col += k){
+    size_t width = min(k, c - col);
+    rows.clear();
+    for(size_t t = 0; t < width; ++t)
+      rows.push_back(other.row(col + t));
+    makeTable(rows, other.words, table);
+    for(size_t i = 0; i < r; ++i){
+      uint64_t index = getBits(i, col, width);
+      if(index == 0)
+        continue;
+      const uint64_t * add = &table[index * other.words];
+      uint64_t * p = out->row(i);
+      for(size_t w = 0; w < other.words; ++w)
+        p[w] ^= add[w];
+    }
+  }
+  return out;
+}
+//---------------------------------------------------------------------------------------
+BitMatrix * BitMatrix::transpose() const{
+  BitMatrix * out = new BitMatrix(c, r);
+  for(size_t i = 0; i < r; ++i){
+    uint64_t bit = (uint64_t) 1 << (i % WORD_BITS);
+    forEachNonZeroInRow(i, [&](size_t j, double){
+      out->row(j)[i / WORD_BITS] |= bit;
+    });
+  }
+  return out;
+}
+//---------------------------------------------------------------------------------------
+BitMatrix * BitMatrix::echelon() const{
+  BitMatrix * out = new BitMatrix(*this);
+  out->eliminate(c, true);
+  return out;
+}
+//---------------------------------------------------------------------------------------
+size_t BitMatrix::rank() const{
+  BitMatrix tmp(*this);
+  return tmp.eliminate(c, false);
+}
+//---------------------------------------------------------------------------------------
+BitMatrix * BitMatrix::solve(const BitMatrix & b) const{
+  BitMatrix tmp(r, c + b.c);
+  for(size_t i = 0; i < r; ++i){
+    copy(row(i), row(i) + words, tmp.row(i));
+    b.forEachNonZeroInRow(i, [&](size_t j, double x){
+      tmp.setValue(i, c + j, x);
+    });
+  }
+  if(tmp.eliminate(c, true) < c)
+    return NULL;
+  //rows of eliminated matrix are identity followed by solution
+  BitMatrix * out = new BitMatrix(c, b.c);
+  for(size_t i = 0; i < c; ++i)
+    for(size_t w = 0; w < out->words; ++w){
+      size_t j = w * WORD_BITS;
+      out->row(i)[w] = tmp.getBits(i, c + j, min(WORD_BITS, b.c - j));
+    }
+  return out;
+}
@@ -0,0 +1,150 @@
+#ifndef BITMATRIX_HPP
+#define BITMATRIX_HPP
+
+#include <cstdint>
+#include "matrixType.hpp"
+
+/**
+  * @brief Implementation of matrix over GF(2) as array of bits.
+  *
+  * Every row is stored in 64-bit words, <i>j</i>-th column is bit j % 64 of word j / 64.
+  * Bits after the last column are always zero. Sum is XOR of words, elimination and
+  * product use the Method of Four Russians: <i>k</i> rows are combined in all
+  * 2<sup>k</sup> ways into a table and every other row is then updated by one table row
+  * instead of up to <i>k</i> rows. Elimination costs O(n<sup>3</sup> / (64 k)) word
+  * operations.
+  */
+class BitMatrix : public MatrixType{
+  private:
+    size_t words; ///< Number of words of one row.
+    std::vector<uint64_t> data; ///< Rows of bits.
+
+    /**
+      * @brief Returns <i>i</i>-th row.
+      * @param i row
+      * @return first word of row
+      */
+    uint64_t * row(size_t i);
+    /**
+      * @brief Returns <i>i</i>-th row.
+      * @param i row
+      * @return first word of row
+      */
+    const uint64_t * row(size_t i) const;
+    /**
+      * @brief Returns <i>k</i> bits of <i>i</i>-th row starting at <i>j</i>-th column.
+      * @param i row
+      * @param j first column
+      * @param k number of bits, at most WORD_BITS
+      * @return bits, <i>j</i>-th column is the lowest bit
+      */
+    uint64_t getBits(size_t i, size_t j, size_t k) const;
+    /**
+      * @brief Returns number of rows combined into one table for <i>n</i> rows.
+      * @param n number of rows which are updated from the table
+      * @return number of rows in one table
+      */
+    static size_t tableBits(size_t n);
+    /**
+      * @brief Fills table with all combinations of rows.
+      * <i>t</i>-th entry is XOR of rows whose bits are set in <i>t</i>, every entry is
+      * made from an entry with one row less by one XOR.
+      * @param rows rows
+      * @param length number of words of every row
+      * @param[out] table 2<sup>rows.size()</sup> entries of <i>length</i> words
+      */
+    static void makeTable(const std::vector<const uint64_t *> & rows, size_t length, std::vector<uint64_t> & table);
+    /**
+      * @brief Performs Gauss-Jordan elimination of the first <i>cols</i> columns.
+      * Columns are processed in blocks of tableBits columns. Pivots of a block are found
+      * among rows below the previous pivots, the block is reduced to identity on pivot
+      * columns and every other row is updated from the table of pivot rows.
+      * @param cols number of eliminated columns
+      * @param reduced whether rows above pivots are eliminated too
+      * @return rank of the first <i>cols</i> columns
+      */
+    size_t eliminate(size_t cols, bool reduced);
+  public:
+    /**
+      * @brief Bits of one word.
+      */
+    static const size_t WORD_BITS;
+    /**
+      * @brief Maximum number of rows combined into one table.
+      */
+    static const size_t TABLE_BITS;
+
+    /**
+      * @brief Constructs zero matrix with dimensions r x c.
+      * @param r number of rows
+      * @param c number of columns
+      */
+    BitMatrix(size_t r, size_t c);
+    /**
+      * @brief Reduces integer matrix modulo 2.
+      * @param m integral matrix
+      * @throw MatrixException if an element is not an integer
+      */
+    BitMatrix(const MatrixType & m);
+
+    virtual double getValue(size_t i, size_t j) const;
+    /**
+      * @brief Sets element to <i>x</i> modulo 2.
+      * @param i row
+      * @param j column
+      * @param x integer
+      * @throw MatrixException if <i>x</i> is not an integer
+      */
+    virtual void setValue(size_t i, size_t j, double x);
+    /**
+      * @brief Calls <i>visit</i> for every set bit of <i>i</i>-th row.
+      * Zero words are skipped.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    /**
+      * @brief Computes ratio of zeros by counting bits of words.
+      * @return ratio
+      */
+    virtual double getRatioOfZeros() const;
+    virtual size_t getMemory() const;
+    /**
+      * @brief Makes sum, which is XOR of words.
+      * @param other matrix with the same dimensions
+      * @return new matrix
+      */
+    BitMatrix * add(const BitMatrix & other) const;
+    /**
+      * @brief Makes product by the Method of Four Russians.
+      * Every row of the result is XOR of one table row for every block of columns of
+      * this matrix.
+      * @param other matrix with as many rows as this matrix has columns
+      * @return new matrix
+      */
+    BitMatrix * multiply(const BitMatrix & other) const;
+    /**
+      * @brief Makes transposed matrix.
+      * @return new matrix
+      */
+    BitMatrix * transpose() const;
+    /**
+      * @brief Makes reduced row echelon form.
+      * @return new matrix
+      */
+    BitMatrix * echelon() const;
+    /**
+      * @brief Computes rank.
+      * @return rank
+      */
+    size_t rank() const;
+    /**
+      * @brief Solves this * x = b by elimination of matrix [this | b].
+      * Matrix must be square.
+      * @param b right-hand sides
+      * @return new matrix x or NULL if this matrix is singular
+      */
+    BitMatrix * solve(const BitMatrix & b) const;
+};
+
+#endif /* BITMATRIX_HPP */
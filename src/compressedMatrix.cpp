@@ -0,0 +1,238 @@
+#include "compressedMatrix.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+using namespace std;
+
+const size_t CompressedMatrix::MIN_MATCH = 4;
+const size_t CompressedMatrix::MAX_OFFSET = 65535;
+const size_t CompressedMatrix::HASH_BITS = 16;
+
+namespace{
+  /**
+    * @brief Appends rest of length which does not fit into four bits of token.
+    * @param[out] out bytes
+    * @param x rest of length
+    */
+  void putLength(string & out, size_t x){
+    for(; x >= 255; x -= 255)
+      out += (char) 255;
+    out += (char) x;
+  }
+
+  /**
+    * @brief Reads rest of length.
+    * @param in bytes
+    * @param[in, out] pos position in <i>in</i>
+    * @return rest of length
+    */
+  size_t getLength(const string & in, size_t & pos){
+    size_t x = 0;
+    unsigned char b;
+    do{
+      b = in[pos++];
+      x += b;
+    }while(b == 255);
+    return x;
+  }
+
+  /**
+    * @brief Appends one sequence of literals and match.
+    * @param[out] out bytes
+    * @param literals literals
+    * @param count number of literals
+    * @param offset distance of match
+    * @param match length of match, 0 for the last sequence without match
+    * @param minMatch shortest match
+    */
+  void putSequence(string & out, const char * literals, size_t count, size_t offset, size_t match, size_t minMatch){
+    size_t rest = match ? match - minMatch : 0;
+    out += (char) ((min<size_t>(count, 15) << 4) | min<size_t>(rest, 15));
+    if(count >= 15)
+      putLength(out, count - 15);
+    out.append(literals, count);
+    if(match == 0)
+      return;
+    out += (char) (offset & 255);
+    out += (char) (offset >> 8);
+    if(rest >= 15)
+      putLength(out, rest - 15);
+  }
+}
+
+CompressedMatrix::CompressedMatrix(const Matrix & m)
+  : r(m.getRows()), c(m.getCols()), single(m.isSinglePrecision()){
+  if(m.isBinaryField())
+    throw MatrixException("Matrix over GF(2) cannot be compressed!");
+  size_t nonZeros = m.countNonZeros();
+  sparse = 2 * nonZeros < r * c;
+  string bytes;
+  if(sparse){
+    vector<size_t> rowPtr(r + 1), cols(nonZeros);
+    vector<double> values(nonZeros);
+    m.copyTo(rowPtr.data(), cols.data(), values.data());
+    for(size_t i = 0; i < r; ++i)
+      putNumber(bytes, rowPtr[i + 1] - rowPtr[i]);
+    for(size_t i = 0; i < r; ++i)
+      for(size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k)
+        putNumber(bytes, k == rowPtr[i] ? cols[k] : cols[k] - cols[k - 1] - 1);
+    shuffle(bytes, values.data(), nonZeros);
+  }
+  else{
+    vector<double> values(r * c);
+    m.copyTo(values.data());
+    if(single){
+      vector<float> tmp(values.begin(), values.end());
+      shuffle(bytes, tmp.data(), tmp.size());
+    }
+    else
+      shuffle(bytes, values.data(), values.size());
+  }
+  length = bytes.size();
+  data = compress(bytes);
+}
+//---------------------------------------------------------------------------------------
+CompressedMatrix::CompressedMatrix(const char * bytes, size_t size){
+  size_t pos = 0;
+  r = getNumber(bytes, pos);
+  c = getNumber(bytes, pos);
+  unsigned char flags = bytes[pos++];
+  single = flags & 1;
+  sparse = flags & 2;
+  length = getNumber(bytes, pos);
+  data.assign(bytes + pos, size - pos);
+}
+//---------------------------------------------------------------------------------------
+string CompressedMatrix::serialize() const{
+  string out;
+  putNumber(out, r);
+  putNumber(out, c);
+  out += (char) (single | sparse << 1);
+  putNumber(out, length);
+  return out + data;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void CompressedMatrix::shuffle(string & out, const T * values, size_t count){
+  const char * in = reinterpret_cast<const char *>(values);
+  size_t start = out.size();
+  out.resize(start + count * sizeof(T));
+  for(size_t b = 0; b < sizeof(T); ++b)
+    for(size_t i = 0; i < count; ++i)
+      out[start + b * count + i] = in[i * sizeof(T) + b];
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void CompressedMatrix::unshuffle(const string & in, size_t & pos, T * values, size_t count){
+  char * out = reinterpret_cast<char *>(values);
+  for(size_t b = 0; b < sizeof(T); ++b)
+    for(size_t i = 0; i < count; ++i)
+      out[i * sizeof(T) + b] = in[pos + b * count + i];
+  pos += count * sizeof(T);
+}
+//---------------------------------------------------------------------------------------
+void CompressedMatrix::putNumber(string & out, size_t x){
+  for(; x >= 128; x >>= 7)
+    out += (char) (x | 128);
+  out += (char) x;
+}
+//---------------------------------------------------------------------------------------
+size_t CompressedMatrix::getNumber(const char * in, size_t & pos){
+  size_t x = 0;
+  for(size_t shift = 0; ; shift += 7){
+    unsigned char b = in[pos++];
+    x |= (size_t) (b & 127) << shift;
+    if(b < 128)
+      return x;
+  }
+}
+//---------------------------------------------------------------------------------------
+string CompressedMatrix::compress(const string & in){
+  string out;
+  vector<size_t> table((size_t) 1 << HASH_BITS, in.size());
+  const char * p = in.data();
+  size_t n = in.size(), anchor = 0, i = 0;
+  while(i + MIN_MATCH <= n){
+    uint32_t v;
+    memcpy(&v, p + i, sizeof(v));
+    size_t h = (v * 2654435761u) >> (32 - HASH_BITS);
+    size_t candidate = table[h];
+    table[h] = i;
+    if(candidate >= i || i - candidate > MAX_OFFSET || memcmp(p + candidate, p + i, MIN_MATCH) != 0){
+      ++i;
+      continue;
+    }
+    size_t match = MIN_MATCH;
+    while(i + match < n && p[candidate + match] == p[i + match])
+      ++match;
+    putSequence(out, p + anchor, i - anchor, i - candidate, match, MIN_MATCH);
+    i += match;
+    anchor = i;
+  }
+  putSequence(out, p + anchor, n - anchor, 0, 0, MIN_MATCH);
+  return out;
+}
+//---------------------------------------------------------------------------------------
+string CompressedMatrix::decompress(const string & in, size_t size){
+  string out;
+  out.reserve(size);
+  size_t pos = 0;
+  while(pos < in.size()){
+    unsigned char token = in[pos++];
+    size_t count = token >> 4;
+    if(count == 15)
+      count += getLength(in, pos);
+    out.append(in, pos, count);
+    pos += count;
+    //only the last sequence has no match
+    if(pos >= in.size())
+      break;
+    size_t offset = (unsigned char) in[pos] | (size_t) (unsigned char) in[pos + 1] << 8;
+    pos += 2;
+    size_t match = token & 15;
+    if(match == 15)
+      match += getLength(in, pos);
+    match += MIN_MATCH;
+    //match can overlap bytes which it writes, so it is copied byte by byte
+    for(size_t from = out.size() - offset; match > 0; --match)
+      out += out[from++];
+  }
+  return out;
+}
+//---------------------------------------------------------------------------------------
+Matrix CompressedMatrix::expand() const{
+  string bytes = decompress(data, length);
+  size_t pos = 0;
+  if(sparse){
+    vector<size_t> counts(r);
+    size_t nonZeros = 0;
+    for(size_t i = 0; i < r; ++i)
+      nonZeros += counts[i] = getNumber(bytes.data(), pos);
+    vector<size_t> cols(nonZeros);
+    for(size_t i = 0, k = 0; i < r; ++i)
+      for(size_t t = 0; t < counts[i]; ++t, ++k)
+        cols[k] = t == 0 ? getNumber(bytes.data(), pos) : cols[k - 1] + 1 + getNumber(bytes.data(), pos);
+    vector<double> values(nonZeros);
+    unshuffle(bytes, pos, values.data(), nonZeros);
+    //elements are inserted in order, so every insertion takes constant time
+    SparseMatrix * tmp = new SparseMatrix(r, c);
+    for(size_t i = 0, k = 0; i < r; ++i)
+      for(size_t t = 0; t < counts[i]; ++t, ++k)
+        tmp->setValue(i, cols[k], values[k]);
+    Matrix out(r, c, tmp);
+    return single ? out.toSingle() : out;
+  }
+  if(single){
+    FloatMatrix * tmp = new FloatMatrix(r, c);
+    unshuffle(bytes, pos, tmp->getData(), r * c);
+    return Matrix(r, c, tmp);
+  }
+  DenseMatrix * tmp = new DenseMatrix(r, c);
+  unshuffle(bytes, pos, tmp->getData(), r * c);
+  return Matrix(r, c, tmp);
+}
+//---------------------------------------------------------------------------------------
+size_t CompressedMatrix::getSize() const{
+  return data.size();
+}
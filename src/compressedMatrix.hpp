@@ -0,0 +1,120 @@
+#ifndef COMPRESSEDMATRIX_HPP
+#define COMPRESSEDMATRIX_HPP
+
+#include <string>
+#include "matrix.hpp"
+
+/**
+  * @brief Lossless compressed copy of matrix which is not used for a long time.
+  *
+  * Elements are first encoded as bytes and the bytes are then compressed by LZ77 in the
+  * block format of LZ4: every sequence is a token with lengths of literals and of match,
+  * the literals and a 16-bit offset of the match.
+  * - Dense matrix is stored as array of elements in its precision. Bytes are shuffled,
+  *   first bytes of all elements go first, then second bytes and so on, so exponents and
+  *   zero low bytes of integer values form long runs.
+  * - Sparse matrix is stored by rows: number of elements of every row and columns as
+  *   differences from the previous column, both as variable-length integers, then
+  *   shuffled values.
+  *
+  * Matrix made by expand gets its storage and structure the same way as any other new
+  * matrix. Matrices over GF(2) are not compressed, BitMatrix is already packed.
+  */
+class CompressedMatrix{
+  private:
+    size_t r, ///< Number of rows.
+           c; ///< Number of columns.
+    bool single, ///< Matrix is in single precision.
+         sparse; ///< Elements are encoded by rows.
+    size_t length; ///< Number of encoded bytes.
+    std::string data; ///< Compressed bytes.
+
+    /**
+      * @brief Shortest match of compression.
+      */
+    static const size_t MIN_MATCH;
+    /**
+      * @brief Largest distance of match.
+      */
+    static const size_t MAX_OFFSET;
+    /**
+      * @brief Number of bits of hash of four bytes.
+      */
+    static const size_t HASH_BITS;
+
+    /**
+      * @brief Appends elements with their bytes shuffled.
+      * @param[out] out bytes
+      * @param values elements
+      * @param count number of elements
+      */
+    template<typename T>
+    static void shuffle(std::string & out, const T * values, size_t count);
+    /**
+      * @brief Reads elements with shuffled bytes.
+      * @param in bytes
+      * @param[in, out] pos position in <i>in</i>
+      * @param[out] values elements
+      * @param count number of elements
+      */
+    template<typename T>
+    static void unshuffle(const std::string & in, size_t & pos, T * values, size_t count);
+    /**
+      * @brief Appends variable-length integer, seven bits in every byte.
+      * @param[out] out bytes
+      * @param x integer
+      */
+    static void putNumber(std::string & out, size_t x);
+    /**
+      * @brief Reads variable-length integer.
+      * @param in bytes
+      * @param[in, out] pos position in <i>in</i>
+      * @return integer
+      */
+    static size_t getNumber(const char * in, size_t & pos);
+    /**
+      * @brief Compresses bytes.
+      * Matches are found by a table of the last positions of hashes of four bytes.
+      * @param in bytes
+      * @return compressed bytes
+      */
+    static std::string compress(const std::string & in);
+    /**
+      * @brief Decompresses bytes.
+      * @param in compressed bytes
+      * @param size number of bytes before compression
+      * @return bytes
+      */
+    static std::string decompress(const std::string & in, size_t size);
+  public:
+    /**
+      * @brief Compresses matrix.
+      * Dense encoding is used if at least half of the elements are non-zero.
+      * @throw MatrixException if matrix is over GF(2)
+      * @param m matrix
+      */
+    explicit CompressedMatrix(const Matrix & m);
+    /**
+      * @brief Reads matrix written by serialize.
+      * @param bytes bytes
+      * @param size number of bytes
+      */
+    CompressedMatrix(const char * bytes, size_t size);
+    /**
+      * @brief Writes dimensions, flags and compressed bytes.
+      * @return bytes
+      */
+    std::string serialize() const;
+    /**
+      * @brief Decompresses matrix.
+      * @return matrix with the same elements and precision
+      */
+    Matrix expand() const;
+    /**
+      * @brief Returns number of compressed bytes.
+      * @return bytes
+      */
+    size_t getSize() const;
+};
+
+#endif /* COMPRESSEDMATRIX_HPP */
@@ -1,24 +1,59 @@
 #include "denseMatrix.hpp"
 
-DenseMatrix::DenseMatrix(size_t r, size_t c) : MatrixType(r, c){
-  data = new double * [r];
-  for(size_t i = 0; i < r; ++i){
-    data[i] = new double [c];
-    for(size_t j = 0; j < c; ++j)
-      data[i][j] = 0;
-  }
+template<typename T>
+BasicDenseMatrix<T>::BasicDenseMatrix(size_t r, size_t c) : MatrixType(r, c), owned(true){
+  data = new T [r * c];
+  for(size_t i = 0; i < r * c; ++i)
+    data[i] = 0;
 }
 //---------------------------------------------------------------------------------------
-DenseMatrix::~DenseMatrix(){
-  for(size_t i = 0; i < r; ++i)
-    delete [] data[i];
-  delete [] data;
+template<typename T>
+BasicDenseMatrix<T>::BasicDenseMatrix(size_t r, size_t c, T * data) : MatrixType(r, c), data(data), owned(false){
 }
 //---------------------------------------------------------------------------------------
-double DenseMatrix::getValue(size_t i, size_t j) const{
-  return data[i][j];
+template<typename T>
+BasicDenseMatrix<T>::~BasicDenseMatrix(){
+  if(owned)
+    delete [] data;
 }
 //---------------------------------------------------------------------------------------
-void DenseMatrix::setValue(size_t i, size_t j, double x){
-  data[i][j] = x;
+template<typename T>
+double BasicDenseMatrix<T>::getValue(size_t i, size_t j) const{
+  return data[i * c + j];
 }
+//---------------------------------------------------------------------------------------
+template<typename T>
+void BasicDenseMatrix<T>::setValue(size_t i, size_t j, double x){
+  data[i * c + j] = x;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void BasicDenseMatrix<T>::forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const{
+  const T * row = data + i * c;
+  for(size_t j = 0; j < c; ++j)
+    if(row[j] != 0)
+      visit(j, row[j]);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+size_t BasicDenseMatrix<T>::getMemory() const{
+  return owned ? r * c * sizeof(T) : 0;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+T * BasicDenseMatrix<T>::getData(){
+  return data;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+const T * BasicDenseMatrix<T>::getData() const{
+  return data;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+bool BasicDenseMatrix<T>::isOwned() const{
+  return owned;
+}
+//---------------------------------------------------------------------------------------
+template class BasicDenseMatrix<double>;
+template class BasicDenseMatrix<float>;
@@ -4,28 +4,64 @@
 #include "matrixType.hpp"
 
 /**
-  * @brief Implementation of matrix as 2D array.
-  * 
-  * This implementation is used for dense matrices. Dense matrix is a matrix where only  
-  * a few elements are equal to zero.
+  * @brief Implementation of matrix as array.
+  *
+  * This implementation is used for dense matrices. Dense matrix is a matrix where only
+  * a few elements are equal to zero. Elements are stored row by row in one array of
+  * type T, which is instantiated for <b>double</b> (DenseMatrix) and for <b>float</b>
+  * (FloatMatrix).
   */
-class DenseMatrix : public MatrixType{
+template<typename T>
+class BasicDenseMatrix : public MatrixType{
   private:
-    double ** data; ///< 2D array where elements are stored.
+    T * data; ///< Array where elements are stored row by row.
+    bool owned; ///< Whether array is freed by this matrix.
   public:
     /**
       * @brief Constructs matrix with dimensions r x c.
       * @param r number of rows
       * @param c number of columns
       */
-    DenseMatrix(size_t r, size_t c);
+    BasicDenseMatrix(size_t r, size_t c);
+    /**
+      * @brief Constructs matrix with dimensions r x c in array of the caller.
+      * Array is not copied and not freed, it must exist as long as the matrix.
+      * @param r number of rows
+      * @param c number of columns
+      * @param data r * c elements stored row by row
+      */
+    BasicDenseMatrix(size_t r, size_t c, T * data);
     /**
       * @brief Frees allocated memory.
-      */ 
-    ~DenseMatrix();
-    
+      */
+    ~BasicDenseMatrix();
+
     virtual double getValue(size_t i, size_t j) const;
     virtual void setValue(size_t i, size_t j, double x);
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    /**
+      * @brief Returns size of array, array of the caller is not counted.
+      * @return bytes
+      */
+    virtual size_t getMemory() const;
+    /**
+      * @brief Returns array where elements are stored row by row.
+      * @return array
+      */
+    T * getData();
+    /**
+      * @brief Returns array where elements are stored row by row.
+      * @return array
+      */
+    const T * getData() const;
+    /**
+      * @brief Tells whether array is freed by this matrix.
+      * @return false if array belongs to the caller otherwise true
+      */
+    bool isOwned() const;
 };
 
+typedef BasicDenseMatrix<double> DenseMatrix; ///< Dense matrix in double precision.
+typedef BasicDenseMatrix<float> FloatMatrix; ///< Dense matrix in single precision.
+
 #endif /* DENSEMATRIX_HPP */
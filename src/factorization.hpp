@@ -0,0 +1,38 @@
+#ifndef FACTORIZATION_HPP
+#define FACTORIZATION_HPP
+
+#include <vector>
+#include <cstddef>
+
+/**
+  * @brief Base class for factorizations of matrices.
+  * Factorization is computed once and then it can be used for determinant and for
+  * solving systems of linear equations with any number of right-hand sides.
+  */
+class Factorization{
+  public:
+    /**
+      * @brief Default destructor.
+      */
+    virtual ~Factorization() = default;
+    /**
+      * @brief Tells whether factored matrix is singular.
+      * @return true if matrix is singular otherwise false
+      */
+    virtual bool isSingular() const = 0;
+    /**
+      * @brief Returns determinant of factored matrix.
+      * @return determinant
+      */
+    virtual double getDeterminant() const = 0;
+    /**
+      * @brief Solves AX = B.
+      * Matrix must not be singular. <i>B</i> has as many rows as A and <i>cols</i>
+      * columns and it is stored row by row. Solution overwrites <i>B</i>.
+      * @param[in, out] b right-hand sides
+      * @param cols number of right-hand sides
+      */
+    virtual void solve(std::vector<double> & b, size_t cols) const = 0;
+};
+
+#endif /* FACTORIZATION_HPP */
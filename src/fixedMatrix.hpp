@@ -0,0 +1,514 @@
+#ifndef FIXEDMATRIX_HPP
+#define FIXEDMATRIX_HPP
+
+#include <cstddef>
+#include <cmath>
+#include <vector>
+#include <algorithm>
+#include <type_traits>
+#include "matrixException.hpp"
+
+/**
+  * @brief Determinant of N x N matrix in closed form.
+  *
+  * Matrix is read through accessor <i>a</i>, where a(i, j) returns element in
+  * <i>i</i>-th row and <i>j</i>-th column. The same formula is therefore used for one
+  * FixedMatrix and for a lane of FixedBatch. Closed form exists for N up to 4.
+  */
+template<typename T, size_t N>
+struct FixedDeterminant;
+
+/**
+  * @brief Accessor of minor of a matrix.
+  * Minor is the matrix without <i>row</i>-th row and <i>col</i>-th column.
+  */
+template<typename A>
+struct FixedMinor{
+  const A & a; ///< Accessor of the whole matrix.
+  size_t row, ///< Removed row.
+         col; ///< Removed column.
+  /**
+    * @brief Returns element of minor.
+    * @param i row
+    * @param j column
+    * @return element
+    */
+  auto operator ()(size_t i, size_t j) const -> decltype(a(i, j)){
+    return a(i + (i >= row), j + (j >= col));
+  }
+};
+
+/// Determinant of 0 x 0 matrix, the only cofactor of 1 x 1 matrix.
+template<typename T>
+struct FixedDeterminant<T, 0>{
+  /// @brief Computes determinant. @param a accessor @return determinant
+  template<typename A>
+  static T compute(const A &){
+    return 1;
+  }
+};
+
+/// Determinant of 1 x 1 matrix.
+template<typename T>
+struct FixedDeterminant<T, 1>{
+  /// @brief Computes determinant. @param a accessor @return determinant
+  template<typename A>
+  static T compute(const A & a){
+    return a(0, 0);
+  }
+};
+
+/// Determinant of 2 x 2 matrix.
+template<typename T>
+struct FixedDeterminant<T, 2>{
+  /// @brief Computes determinant. @param a accessor @return determinant
+  template<typename A>
+  static T compute(const A & a){
+    return a(0, 0) * a(1, 1) - a(0, 1) * a(1, 0);
+  }
+};
+
+/// Determinant of 3 x 3 matrix (rule of Sarrus).
+template<typename T>
+struct FixedDeterminant<T, 3>{
+  /// @brief Computes determinant. @param a accessor @return determinant
+  template<typename A>
+  static T compute(const A & a){
+    return a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+         - a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+         + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+  }
+};
+
+/// Determinant of 4 x 4 matrix (expansion by 2 x 2 minors of the first two rows).
+template<typename T>
+struct FixedDeterminant<T, 4>{
+  /// @brief Computes determinant. @param a accessor @return determinant
+  template<typename A>
+  static T compute(const A & a){
+    T s0 = a(0, 0) * a(1, 1) - a(1, 0) * a(0, 1), s1 = a(0, 0) * a(1, 2) - a(1, 0) * a(0, 2),
+      s2 = a(0, 0) * a(1, 3) - a(1, 0) * a(0, 3), s3 = a(0, 1) * a(1, 2) - a(1, 1) * a(0, 2),
+      s4 = a(0, 1) * a(1, 3) - a(1, 1) * a(0, 3), s5 = a(0, 2) * a(1, 3) - a(1, 2) * a(0, 3),
+      c5 = a(2, 2) * a(3, 3) - a(3, 2) * a(2, 3), c4 = a(2, 1) * a(3, 3) - a(3, 1) * a(2, 3),
+      c3 = a(2, 1) * a(3, 2) - a(3, 1) * a(2, 2), c2 = a(2, 0) * a(3, 3) - a(3, 0) * a(2, 3),
+      c1 = a(2, 0) * a(3, 2) - a(3, 0) * a(2, 2), c0 = a(2, 0) * a(3, 1) - a(3, 0) * a(2, 1);
+    return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  }
+};
+
+/**
+  * @brief Matrix with dimensions known at compile time.
+  *
+  * Elements are stored row by row in an array inside the object, so no memory is
+  * allocated and all loops have constant bounds which compiler unrolls. It is meant for
+  * tiny matrices (up to 8 x 8) where overhead of MatrixType would be larger than the
+  * arithmetic itself.
+  */
+template<typename T, size_t R, size_t C>
+class FixedMatrix{
+  private:
+    T data[R * C]; ///< Elements stored row by row.
+  public:
+    /**
+      * @brief Constructs zero matrix.
+      */
+    constexpr FixedMatrix() : data(){
+    }
+    /**
+      * @brief Returns element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    T & operator ()(size_t i, size_t j){
+      return data[i * C + j];
+    }
+    /**
+      * @brief Returns element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    constexpr T operator ()(size_t i, size_t j) const{
+      return data[i * C + j];
+    }
+    /**
+      * @brief Returns elements stored row by row.
+      * @return elements
+      */
+    T * getData(){
+      return data;
+    }
+    /**
+      * @brief Returns elements stored row by row.
+      * @return elements
+      */
+    const T * getData() const{
+      return data;
+    }
+    /**
+      * @brief Makes matrix which is multiplication of this matrix and other matrix.
+      * @param other other matrix
+      * @return product
+      */
+    template<size_t K>
+    FixedMatrix<T, R, K> operator *(const FixedMatrix<T, C, K> & other) const{
+      FixedMatrix<T, R, K> out;
+      for(size_t i = 0; i < R; ++i)
+        for(size_t k = 0; k < C; ++k)
+          for(size_t j = 0; j < K; ++j)
+            out(i, j) += (*this)(i, k) * other(k, j);
+      return out;
+    }
+    /**
+      * @brief Makes matrix which is sum of this matrix and other matrix.
+      * @param other other matrix
+      * @return sum
+      */
+    FixedMatrix operator +(const FixedMatrix & other) const{
+      FixedMatrix out;
+      for(size_t i = 0; i < R * C; ++i)
+        out.data[i] = data[i] + other.data[i];
+      return out;
+    }
+    /**
+      * @brief Returns transposed matrix.
+      * @return transposed matrix
+      */
+    FixedMatrix<T, C, R> transpose() const{
+      FixedMatrix<T, C, R> out;
+      for(size_t i = 0; i < R; ++i)
+        for(size_t j = 0; j < C; ++j)
+          out(j, i) = (*this)(i, j);
+      return out;
+    }
+};
+
+/**
+  * @brief Determinant and inverse of square FixedMatrix.
+  * Matrices up to 4 x 4 use closed form (FixedDeterminant and adjugate), bigger
+  * matrices use unrolled elimination with partial pivoting.
+  */
+template<typename T, size_t N, bool CLOSED = (N <= 4)>
+struct FixedSquare{
+  /**
+    * @brief Computes determinant.
+    * @param m matrix
+    * @return determinant
+    */
+  static T determinant(const FixedMatrix<T, N, N> & m){
+    return FixedDeterminant<T, N>::compute(m);
+  }
+  /**
+    * @brief Computes inverse as adjugate divided by determinant.
+    * @param m matrix
+    * @param[out] out inverse, unchanged if matrix is singular
+    * @return determinant
+    */
+  static T invert(const FixedMatrix<T, N, N> & m, FixedMatrix<T, N, N> & out){
+    T det = determinant(m);
+    if(det == 0)
+      return det;
+    for(size_t i = 0; i < N; ++i)
+      for(size_t j = 0; j < N; ++j){
+        FixedMinor<FixedMatrix<T, N, N> > minor = {m, j, i};
+        T cofactor = FixedDeterminant<T, N - 1>::compute(minor);
+        out(i, j) = ((i + j) % 2 ? -cofactor : cofactor) / det;
+      }
+    return det;
+  }
+  /**
+    * @brief Computes inverse.
+    * @throw MatrixException
+    * @param m matrix
+    * @return inverse
+    */
+  static FixedMatrix<T, N, N> inverse(const FixedMatrix<T, N, N> & m){
+    FixedMatrix<T, N, N> out;
+    if(invert(m, out) == 0)
+      throw MatrixException("Singular matrix!");
+    return out;
+  }
+};
+
+/// Inverse of 1 x 1 matrix.
+template<typename T>
+struct FixedSquare<T, 1, true>{
+  /// @brief Computes determinant. @param m matrix @return determinant
+  static T determinant(const FixedMatrix<T, 1, 1> & m){
+    return m(0, 0);
+  }
+  /// @brief Computes inverse. @param m matrix @param[out] out inverse @return determinant
+  static T invert(const FixedMatrix<T, 1, 1> & m, FixedMatrix<T, 1, 1> & out){
+    if(m(0, 0) != 0)
+      out(0, 0) = 1 / m(0, 0);
+    return m(0, 0);
+  }
+  /// @brief Computes inverse. @throw MatrixException @param m matrix @return inverse
+  static FixedMatrix<T, 1, 1> inverse(const FixedMatrix<T, 1, 1> & m){
+    FixedMatrix<T, 1, 1> out;
+    if(invert(m, out) == 0)
+      throw MatrixException("Singular matrix!");
+    return out;
+  }
+};
+
+/// Determinant and inverse of matrices bigger than 4 x 4.
+template<typename T, size_t N>
+struct FixedSquare<T, N, false>{
+  /**
+    * @brief Eliminates matrix with partial pivoting.
+    * @param[in, out] m matrix, upper triangular on exit
+    * @param[in, out] inv matrix with the same row operations applied, or NULL
+    * @return determinant
+    */
+  static T eliminate(FixedMatrix<T, N, N> & m, FixedMatrix<T, N, N> * inv){
+    T det = 1;
+    for(size_t k = 0; k < N; ++k){
+      size_t p = k;
+      for(size_t i = k + 1; i < N; ++i)
+        if(std::fabs(m(i, k)) > std::fabs(m(p, k)))
+          p = i;
+      if(m(p, k) == 0)
+        return 0;
+      if(p != k){
+        det = -det;
+        for(size_t j = 0; j < N; ++j){
+          std::swap(m(p, j), m(k, j));
+          if(inv)
+            std::swap((*inv)(p, j), (*inv)(k, j));
+        }
+      }
+      det *= m(k, k);
+      for(size_t i = k + 1; i < N; ++i){
+        T l = m(i, k) / m(k, k);
+        for(size_t j = k; j < N; ++j)
+          m(i, j) -= l * m(k, j);
+        if(inv)
+          for(size_t j = 0; j < N; ++j)
+            (*inv)(i, j) -= l * (*inv)(k, j);
+      }
+    }
+    return det;
+  }
+  /// @brief Computes determinant. @param m matrix @return determinant
+  static T determinant(FixedMatrix<T, N, N> m){
+    return eliminate(m, NULL);
+  }
+  /// @brief Computes inverse. @param m matrix @param[out] out inverse @return determinant
+  static T invert(FixedMatrix<T, N, N> m, FixedMatrix<T, N, N> & out){
+    FixedMatrix<T, N, N> tmp;
+    for(size_t i = 0; i < N; ++i)
+      tmp(i, i) = 1;
+    T det = eliminate(m, &tmp);
+    if(det == 0)
+      return det;
+    for(size_t i = N; i-- > 0;){
+      for(size_t k = i + 1; k < N; ++k)
+        for(size_t j = 0; j < N; ++j)
+          tmp(i, j) -= m(i, k) * tmp(k, j);
+      for(size_t j = 0; j < N; ++j)
+        tmp(i, j) /= m(i, i);
+    }
+    out = tmp;
+    return det;
+  }
+  /// @brief Computes inverse. @throw MatrixException @param m matrix @return inverse
+  static FixedMatrix<T, N, N> inverse(const FixedMatrix<T, N, N> & m){
+    FixedMatrix<T, N, N> out;
+    if(invert(m, out) == 0)
+      throw MatrixException("Singular matrix!");
+    return out;
+  }
+};
+
+/**
+  * @brief Returns determinant of square FixedMatrix.
+  * @param m matrix
+  * @return determinant
+  */
+template<typename T, size_t N>
+T determinant(const FixedMatrix<T, N, N> & m){
+  return FixedSquare<T, N>::determinant(m);
+}
+
+/**
+  * @brief Returns inverse of square FixedMatrix.
+  * @throw MatrixException
+  * @param m matrix
+  * @return inverse
+  */
+template<typename T, size_t N>
+FixedMatrix<T, N, N> inverse(const FixedMatrix<T, N, N> & m){
+  return FixedSquare<T, N>::inverse(m);
+}
+
+/**
+  * @brief Array of N x N matrices stored as structure of arrays.
+  *
+  * Element (i, j) of all matrices is stored in one contiguous array, so operations
+  * process many matrices at once and the innermost loop over matrices is vectorized.
+  * Determinants and inverses of matrices up to 4 x 4 use closed forms over all lanes,
+  * bigger matrices are eliminated one by one.
+  */
+template<typename T, size_t N>
+class FixedBatch{
+  private:
+    size_t count; ///< Number of matrices.
+    std::vector<T> data; ///< Element (i, j) of <i>b</i>-th matrix is at (i * N + j) * count + b.
+
+    /**
+      * @brief Accessor of one matrix of the batch.
+      */
+    struct Lane{
+      const T * base; ///< Element (0, 0) of the matrix.
+      size_t stride; ///< Distance between two elements of the matrix.
+      /// @brief Returns element. @param i row @param j column @return element
+      T operator ()(size_t i, size_t j) const{
+        return base[(i * N + j) * stride];
+      }
+    };
+
+    /// @brief Computes determinants in closed form. @param[out] out determinants
+    void determinants(std::vector<T> & out, std::true_type) const{
+      for(size_t m = 0; m < count; ++m){
+        Lane lane = {&data[m], count};
+        out[m] = FixedDeterminant<T, N>::compute(lane);
+      }
+    }
+    /// @brief Computes determinants by elimination. @param[out] out determinants
+    void determinants(std::vector<T> & out, std::false_type) const{
+      for(size_t m = 0; m < count; ++m)
+        out[m] = FixedSquare<T, N>::determinant(getMatrix(m));
+    }
+    /**
+      * @brief Computes inverses as adjugates divided by determinants.
+      * @param[out] out inverses
+      * @param[out] dets determinants
+      */
+    void inverses(FixedBatch & out, std::vector<T> & dets, std::true_type) const{
+      determinants(dets, std::true_type());
+      std::vector<T> scale(count);
+      for(size_t m = 0; m < count; ++m)
+        scale[m] = dets[m] != 0 ? 1 / dets[m] : 0;
+      for(size_t i = 0; i < N; ++i)
+        for(size_t j = 0; j < N; ++j){
+          T * c = &out.data[(i * N + j) * count];
+          for(size_t m = 0; m < count; ++m){
+            Lane lane = {&data[m], count};
+            FixedMinor<Lane> minor = {lane, j, i};
+            T cofactor = FixedDeterminant<T, N - 1>::compute(minor);
+            c[m] = ((i + j) % 2 ? -cofactor : cofactor) * scale[m];
+          }
+        }
+    }
+    /**
+      * @brief Computes inverses by elimination.
+      * @param[out] out inverses
+      * @param[out] dets determinants
+      */
+    void inverses(FixedBatch & out, std::vector<T> & dets, std::false_type) const{
+      for(size_t m = 0; m < count; ++m){
+        FixedMatrix<T, N, N> inv;
+        dets[m] = FixedSquare<T, N>::invert(getMatrix(m), inv);
+        out.setMatrix(m, inv);
+      }
+    }
+  public:
+    /**
+      * @brief Constructs batch of zero matrices.
+      * @param count number of matrices
+      */
+    FixedBatch(size_t count) : count(count), data(N * N * count, 0){
+    }
+    /**
+      * @brief Returns number of matrices.
+      * @return number of matrices
+      */
+    size_t size() const{
+      return count;
+    }
+    /**
+      * @brief Returns element in <i>i</i>-th row and <i>j</i>-th column of <i>b</i>-th matrix.
+      * @param b matrix
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    T & operator ()(size_t b, size_t i, size_t j){
+      return data[(i * N + j) * count + b];
+    }
+    /**
+      * @brief Returns element in <i>i</i>-th row and <i>j</i>-th column of <i>b</i>-th matrix.
+      * @param b matrix
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    T operator ()(size_t b, size_t i, size_t j) const{
+      return data[(i * N + j) * count + b];
+    }
+    /**
+      * @brief Returns <i>b</i>-th matrix.
+      * @param b matrix
+      * @return copy of matrix
+      */
+    FixedMatrix<T, N, N> getMatrix(size_t b) const{
+      FixedMatrix<T, N, N> out;
+      for(size_t i = 0; i < N * N; ++i)
+        out.getData()[i] = data[i * count + b];
+      return out;
+    }
+    /**
+      * @brief Sets <i>b</i>-th matrix.
+      * @param b matrix
+      * @param m new matrix
+      */
+    void setMatrix(size_t b, const FixedMatrix<T, N, N> & m){
+      for(size_t i = 0; i < N * N; ++i)
+        data[i * count + b] = m.getData()[i];
+    }
+    /**
+      * @brief Multiplies matrices of this batch by matrices of other batch.
+      * @throw MatrixException
+      * @param other other batch of the same size
+      * @return batch of products
+      */
+    FixedBatch operator *(const FixedBatch & other) const{
+      if(count != other.count)
+        throw MatrixException("Wrong dimensions!");
+      FixedBatch out(count);
+      for(size_t i = 0; i < N; ++i)
+        for(size_t k = 0; k < N; ++k)
+          for(size_t j = 0; j < N; ++j){
+            const T * a = &data[(i * N + k) * count], * b = &other.data[(k * N + j) * count];
+            T * c = &out.data[(i * N + j) * count];
+            for(size_t m = 0; m < count; ++m)
+              c[m] += a[m] * b[m];
+          }
+      return out;
+    }
+    /**
+      * @brief Computes determinants of all matrices.
+      * @return determinants
+      */
+    std::vector<T> determinants() const{
+      std::vector<T> out(count);
+      determinants(out, std::integral_constant<bool, (N <= 4)>());
+      return out;
+    }
+    /**
+      * @brief Computes inverses of all matrices.
+      * Inverse of a singular matrix is left zero, its determinant is zero.
+      * @param[out] dets determinants
+      * @return batch of inverses
+      */
+    FixedBatch inverses(std::vector<T> & dets) const{
+      FixedBatch out(count);
+      dets.assign(count, 0);
+      inverses(out, dets, std::integral_constant<bool, (N <= 4)>());
+      return out;
+    }
+};
+
+#endif /* FIXEDMATRIX_HPP */
@@ -1,15 +1,36 @@
 #include "handler.hpp"
+#include <fstream>
+#include <chrono>
+#include <cstdint>
+#include "threadPool.hpp"
+#include "processPool.hpp"
+#include "resultCache.hpp"
 
 using namespace std;
 
 const string Handler::NO_VARS = "No variables stored!";
 const string Handler::ILLEGAL_NAME = "Illegal name for variable!";
 const string Handler::UNKNOWN = "Unknown command!";
+const size_t Handler::MAX_DEPTH = 16;
+const size_t Handler::WINDOW = 64;
+thread_local Handler::Command * Handler::current = NULL;
+//---------------------------------------------------------------------------------------
+Handler::Handler(istream & input, ostream & output, ostream & errors, const shared_ptr<VariableStore> & shared)
+  : shared(shared), input(&input), output(&output), errors(&errors){
+}
 //---------------------------------------------------------------------------------------
 bool Handler::execute(const string & input){
+  Command command;
+  command.text = input;
+  command.out = output;
+  runCommand(command);
+  return !command.exit;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::dispatch(const string & input){
   istringstream iss(input);
   istringstream iss2(input);
-  Matrix tmp;
+  shared_ptr<const Matrix> tmp;
   string first = getNextWord(iss);
   transform(first.begin(), first.end(), first.begin(), ::tolower);
   if(first == "") return true;
@@ -17,34 +38,264 @@ bool Handler::execute(const string & input){
   else if(first == "print") printVariable(iss);
   else if(first == "delete") deleteVariable(iss);
   else if(first == "scan") scanVariable(iss);
-  else if(first == "list") listVariables();
+  else if(first == "list") listVariables(iss);
   else if(first == "determinant") determinant(iss);
   else if(first == "rank") rank(iss);
   else if(first == "help") printHelp();
+  else if(first == "set") setOption(iss);
+  else if(first == "cache") cache(iss);
+  else if(first == "memlimit") memoryLimit(iss);
+  else if(first == "run") runScript(iss);
   else parse(iss2, tmp);
   return true;
 }
 //---------------------------------------------------------------------------------------
+void Handler::runCommand(Command & command){
+  Command * outer = current;
+  current = &command;
+  try{
+    command.exit = !dispatch(command.text);
+  }
+  catch(const exception & e){
+    error(e.what());
+  }
+  current = outer;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::run(const string & file, bool verbose){
+  if(depth == MAX_DEPTH){
+    error("Too many nested scripts!");
+    return false;
+  }
+  ifstream in(file, ios::binary);
+  if(!in){
+    error("Cannot open file '" + file + "'!");
+    return false;
+  }
+  auto start = chrono::steady_clock::now();
+  //whole file is read at once, commands and SCAN payloads are then parsed from memory
+  ostringstream buffer;
+  buffer << in.rdbuf();
+  const string text = buffer.str();
+  istringstream script(text);
+
+  istream * oldInput = input;
+  bool oldVerbose = this->verbose;
+  input = &script;
+  this->verbose = verbose;
+  ++depth;
+  bool ok = true, running = true;
+  size_t line = 1;
+  streamoff last = 0;
+  deque<Command> window;
+  string command;
+  while(running){
+    streamoff begin = script.tellg();
+    if(begin < 0 || !getline(script, command))
+      break;
+    line += count(text.begin() + last, text.begin() + begin, '\n');
+    last = begin;
+    set<string> reads, writes;
+    bool independent = analyze(command, reads, writes);
+    //command which must run alone waits for all earlier commands
+    if(!independent && !window.empty() && !(running = flush(window, file, ok)))
+      break;
+    window.emplace_back();
+    Command & next = window.back();
+    next.text = command;
+    next.line = line;
+    next.script = true;
+    next.reads.swap(reads);
+    next.writes.swap(writes);
+    if(!independent || window.size() == WINDOW)
+      running = flush(window, file, ok);
+  }
+  if(running)
+    flush(window, file, ok);
+  --depth;
+  input = oldInput;
+  this->verbose = oldVerbose;
+
+  chrono::duration<double> elapsed = chrono::steady_clock::now() - start;
+  output->flush();
+  *errors << "Script '" << file << "' " << (ok ? "done" : "failed") << " in " << elapsed.count() << " s" << endl;
+  return ok;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::analyze(const string & text, set<string> & reads, set<string> & writes) const{
+  istringstream iss(text);
+  vector<string> words;
+  string word;
+  while(iss >> word)
+    words.push_back(word);
+  if(words.empty())
+    return true;
+  string first = words[0];
+  transform(first.begin(), first.end(), first.begin(), ::tolower);
+  if(first == "exit" || first == "scan" || first == "delete" || first == "list"
+     || first == "set" || first == "run" || first == "cache" || first == "memlimit" || std::find(words.begin(), words.end(), "-v") != words.end())
+    return false;
+  for(size_t i = 0; i < words.size(); ++i){
+    reads.insert(words[i]);
+    if(i + 1 < words.size() && (words[i + 1] == "=" || isDouble(words[i + 1])))
+      writes.insert(words[i]);
+  }
+  return true;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::conflict(const Command & a, const Command & b){
+  for(const auto & x : a.writes)
+    if(b.reads.count(x))
+      return true;
+  for(const auto & x : b.writes)
+    if(a.reads.count(x))
+      return true;
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::flush(deque<Command> & window, const string & file, bool & ok){
+  size_t n = window.size(), levels = 0;
+  //command runs one level after the last earlier command which it conflicts with
+  vector<size_t> level(n, 0);
+  for(size_t j = 0; j < n; ++j){
+    for(size_t i = 0; i < j; ++i)
+      if(level[i] >= level[j] && conflict(window[i], window[j]))
+        level[j] = level[i] + 1;
+    levels = max(levels, level[j] + 1);
+  }
+  if(n == 1)
+    window[0].out = output;
+  else
+    for(size_t j = 0; j < n; ++j){
+      window[j].out = &window[j].output;
+      window[j].deferred = true;
+      for(size_t i = 0; i < j; ++i)
+        if(conflict(window[i], window[j]))
+          window[j].before.push_back(&window[i]);
+    }
+
+  //commands after the first failed one are not started
+  size_t stop = n;
+  for(size_t l = 0; l < levels; ++l){
+    vector<size_t> now;
+    for(size_t j = 0; j < stop; ++j)
+      if(level[j] == l)
+        now.push_back(j);
+    if(now.size() == 1)
+      runCommand(window[now[0]]);
+    else{
+      vector<future<void> > done;
+      for(size_t j : now)
+        done.push_back(ThreadPool::getInstance().submit([this, &window, j]{ runCommand(window[j]); }));
+      for(auto & f : done)
+        f.get();
+    }
+    for(size_t j : now)
+      if(window[j].failed || window[j].exit)
+        stop = min(stop, j + 1);
+  }
+
+  //kept changes are made in the original order, changes of later commands are dropped
+  for(size_t j = 0; j < stop; ++j)
+    for(const auto & x : window[j].changes){
+      VariableStore & vars = isPrivate(x.var) ? local : *shared;
+      if(x.matrix)
+        vars.store(x.var, x.matrix);
+      else
+        vars.erase(x.var);
+    }
+
+  bool running = true;
+  for(size_t j = 0; j < stop && running; ++j){
+    *output << window[j].output.str();
+    if(window[j].failed){
+      output->flush();
+      *errors << file << ":" << window[j].line << ": " << window[j].error << endl;
+      ok = running = false;
+    }
+    else if(window[j].exit)
+      running = false;
+  }
+  window.clear();
+  return running;
+}
+//---------------------------------------------------------------------------------------
+const Handler::Change * Handler::findChange(const string & var) const{
+  for(auto it = current->changes.rbegin(); it != current->changes.rend(); ++it)
+    if(it->var == var)
+      return &*it;
+  //commands which the current one conflicts with are already finished
+  for(auto it = current->before.rbegin(); it != current->before.rend(); ++it)
+    for(auto x = (*it)->changes.rbegin(); x != (*it)->changes.rend(); ++x)
+      if(x->var == var)
+        return &*x;
+  return NULL;
+}
+//---------------------------------------------------------------------------------------
+void Handler::runScript(istringstream & iss){
+  string file, detail;
+  iss >> file;
+  if(!iss.eof())
+    iss >> detail;
+  if(!iss.eof() || iss.fail() || iss.bad() || (detail != "" && detail != "-v")){
+    error(UNKNOWN);
+    return;
+  }
+  //errors inside the script are already reported, outer script only has to stop
+  if(!run(file, detail == "-v") && current->script)
+    error("Script '" + file + "' failed!");
+}
+//---------------------------------------------------------------------------------------
+ostream & Handler::out() const{
+  //script run directly by run has no command
+  return current ? *current->out : *output;
+}
+//---------------------------------------------------------------------------------------
+void Handler::error(const string & message) const{
+  if(!current || !current->script)
+    out() << message << endl;
+  else if(!current->failed){
+    current->error = message;
+    current->failed = true;
+  }
+}
+//---------------------------------------------------------------------------------------
+bool Handler::echo() const{
+  return verbose || !current->assigning;
+}
+//---------------------------------------------------------------------------------------
 void Handler::printHelp() const{
-  cout << "LIST - print names of all variables" << endl;
-  cout << "PRINT var - print matirx var" << endl;
-  cout << "SCAN var rows cols - scan matrix var with dimensions rows x cols" << endl;
-  cout << "DELETE var - delete matrix var" << endl;
-  cout << "MERGE var1 var2 - merge matrices var1 and var2" << endl;
-  cout << "SPLIT var rows cols posR posC - split matrix from var with dimensions rows x cols starting at position [posR;posC]" << endl;
-  cout << "GEM var [-v] - do Gaussian elimination method to matrix var" << endl;
-  cout << "DETERMINANT var - calculate determinant of matrix var" << endl;
-  cout << "RANK var - calculate rank of matrix var" << endl;
-  cout << "TRANSPOSE var - transpose matrix var" << endl;
-  cout << "INVERSE var - inverse matrix var" << endl; 
-  cout << "var rows cols [val] - make matrix var with dimensions rows x cols and diagonal value val" << endl;
-  cout << "var1 + var2 - sum of matrices var1 and var2" << endl;
-  cout << "var1 - var2 - difference of matrices var1 and var2" << endl;
-  cout << "var1 * var2 - product of matrices var1 and var2" << endl;
-  cout << "var = ... - save result of right side to variable var" << endl;
-}
-//---------------------------------------------------------------------------------------
-bool Handler::parse(istringstream & iss, Matrix & m){
+  out() << "LIST [-v] - print names of all variables, -v prints dimensions, storage, non-zero elements and bytes of every variable" << endl;
+  out() << "PRINT var - print matirx var" << endl;
+  out() << "SCAN var rows cols - scan matrix var with dimensions rows x cols" << endl;
+  out() << "DELETE var - delete matrix var" << endl;
+  out() << "MERGE var1 var2 - merge matrices var1 and var2" << endl;
+  out() << "SPLIT var rows cols posR posC - split matrix from var with dimensions rows x cols starting at position [posR;posC]" << endl;
+  out() << "GEM var [-v] - do Gaussian elimination method to matrix var" << endl;
+  out() << "DETERMINANT var - calculate determinant of matrix var" << endl;
+  out() << "RANK var - calculate rank of matrix var" << endl;
+  out() << "TRANSPOSE var - transpose matrix var" << endl;
+  out() << "INVERSE var - inverse matrix var" << endl; 
+  out() << "SOLVE var1 var2 - solve var1 * x = var2, every column of var2 is one right-hand side" << endl;
+  out() << "SOLVE var1 var2 ITER method [tol=x] [maxit=n] [precond=p] - solve iteratively by cg, bicgstab or gmres with preconditioner none, jacobi or ilu0" << endl;
+  out() << "REORDER var [RCM|ND] [PERM] - reorder rows and columns of var by reverse Cuthill-McKee or nested dissection, PERM gives the permutation (i-th row of the result is perm[i]-th row of var)" << endl;
+  out() << "RUN file [-v] - run commands from file, results of assignments are printed only with -v" << endl;
+  out() << "SET option value - set option (blocksize, exact, strassen, cache, workers, compress)" << endl;
+  out() << "CACHE STATS - print number of cached results, hits and misses" << endl;
+  out() << "CACHE CLEAR - drop all cached results" << endl;
+  out() << "MEMLIMIT [size[K|M|G|T]] - print or set memory limit of variables, least recently used variables over it are spilled to disk, 0 means no limit" << endl;
+  out() << "FLOAT var - convert matrix var to single precision" << endl;
+  out() << "DOUBLE var - convert matrix var to double precision" << endl;
+  out() << "GF2 var - convert integer matrix var to GF(2), operations of such matrices are done modulo 2" << endl;
+  out() << "var rows cols [val] - make matrix var with dimensions rows x cols and diagonal value val" << endl;
+  out() << "var1 + var2 - sum of matrices var1 and var2" << endl;
+  out() << "var1 - var2 - difference of matrices var1 and var2" << endl;
+  out() << "var1 * var2 - product of matrices var1 and var2" << endl;
+  out() << "var1 op TRANSPOSE var2, TRANSPOSE var1 op var2 - operation with transposed matrix which is not made" << endl;
+  out() << "var = ... - save result of right side to variable var" << endl;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::parse(istringstream & iss, shared_ptr<const Matrix> & m){
   string first = getNextWord(iss);
   string tmp = first;
   transform(tmp.begin(), tmp.end(), tmp.begin(), ::tolower);
@@ -53,6 +304,11 @@ bool Handler::parse(istringstream & iss, Matrix & m){
   else if(tmp == "transpose") return transpose(iss, m);
   else if(tmp == "inverse") return inverse(iss, m);
   else if(tmp == "gem") return gem(iss, m);
+  else if(tmp == "solve") return solve(iss, m);
+  else if(tmp == "reorder") return reorder(iss, m);
+  else if(tmp == "float") return precision(iss, m, true);
+  else if(tmp == "double") return precision(iss, m, false);
+  else if(tmp == "gf2") return binaryField(iss, m);
   else if(isDouble(first)) return scalarMultiple(first, iss, m);
   else return variableOperation(first, iss, m);
 }
@@ -84,42 +340,130 @@ bool Handler::isValidVariableName(const string & var) const{
   transform(str.begin(), str.end(), str.begin(), ::tolower);
   if(isDouble(var) || str == "exit" || str == "print" || str == "scan" || str == "list"
      || str == "merge" || str == "rank" || str == "determinant" || str == "split"
-     || str == "gem" || str == "transpose" || str == "inverse" || str == "delete")
+     || str == "gem" || str == "transpose" || str == "inverse" || str == "delete"
+     || str == "set" || str == "run" || str == "cache" || str == "solve" || str == "float" || str == "double"
+     || str == "reorder" || str == "gf2" || str == "memlimit")
     return false;
   return true;
 }
 //---------------------------------------------------------------------------------------
-void Handler::listVariables() const{
-  if(vars.size() == 0){
-    cout << NO_VARS << endl;
+void Handler::listVariables(istringstream & iss) const{
+  string detail = getNextWord(iss);
+  if((detail != "" && detail != "-v") || getNextWord(iss) != ""){
+    error(UNKNOWN);
+    return;
+  }
+  if(detail == ""){
+    set<string> names;
+    local.getNames(names);
+    shared->getNames(names);
+    if(names.size() == 0){
+      out() << NO_VARS << endl;
+      return;
+    }
+    for(const auto & x : names)
+      out() << x << " ";
+    out() << endl;
+    return;
+  }
+  map<string, VariableStore::Info> info;
+  local.getInfo(info);
+  shared->getInfo(info);
+  if(info.size() == 0){
+    out() << NO_VARS << endl;
     return;
   }
-  for(const auto & x : vars)
-    cout << x.first << " ";
-  cout << endl;
+  for(const auto & x : info){
+    const VariableStore::Info & v = x.second;
+    out() << x.first << " " << v.rows << "x" << v.cols << " " << v.storage << " nnz=" << v.nonZeros
+          << " bytes=" << v.bytes;
+    if(v.state != "memory")
+      out() << " " << v.state;
+    out() << endl;
+  }
+  out() << "Total " << VariableStore::getMemoryUsed() << " bytes";
+  if(VariableStore::getMemoryLimit() != 0)
+    out() << " of " << VariableStore::getMemoryLimit();
+  out() << endl;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::getVariable(istringstream & iss, Matrix const * & m) const{
+bool Handler::getVariable(istringstream & iss, shared_ptr<const Matrix> & m, size_t & version) const{
   string var;
   iss >> var;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it = vars.find(var);
-  if(it == vars.cend())
-    cout << "Variable '" << var << "' not found!" << endl;
+  shared_ptr<const Matrix> found = find(var, version);
+  if(!found)
+    error("Variable '" + var + "' not found!");
   else{
-    m = &(it->second);
+    m = found;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
+bool Handler::isPrivate(const string & var){
+  return !var.empty() && var[0] == '_';
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> Handler::find(const string & var) const{
+  size_t version;
+  return find(var, version);
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> Handler::find(const string & var, size_t & version) const{
+  if(current && current->deferred){
+    const Change * x = findChange(var);
+    if(x){
+      version = x->version;
+      return x->matrix;
+    }
+  }
+  return isPrivate(var) ? local.find(var, version) : shared->find(var, version);
+}
+//---------------------------------------------------------------------------------------
+void Handler::store(const string & var, const shared_ptr<const Matrix> & m){
+  if(current && current->deferred){
+    current->changes.push_back(Change{var, m, VariableStore::newVersion()});
+    return;
+  }
+  if(isPrivate(var))
+    local.store(var, m);
+  else
+    shared->store(var, m);
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> Handler::update(const string & var, const function<void(Matrix &)> & change){
+  if(current && current->deferred){
+    shared_ptr<const Matrix> found = find(var);
+    if(!found)
+      return found;
+    //copy shares storage with the found snapshot, which stays unchanged
+    shared_ptr<Matrix> m = make_shared<Matrix>(*found);
+    change(*m);
+    store(var, m);
+    return m;
+  }
+  return isPrivate(var) ? local.update(var, change) : shared->update(var, change);
+}
+//---------------------------------------------------------------------------------------
+bool Handler::erase(const string & var){
+  if(current && current->deferred){
+    if(!find(var))
+      return false;
+    current->changes.push_back(Change{var, shared_ptr<const Matrix>(), VariableStore::newVersion()});
+    return true;
+  }
+  return isPrivate(var) ? local.erase(var) : shared->erase(var);
+}
+//---------------------------------------------------------------------------------------
 void Handler::printVariable(istringstream & iss) const{
-  Matrix const * tmp;
-  if(getVariable(iss, tmp))
-    cout << *tmp;
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v))
+    out() << *tmp;
 }
 //---------------------------------------------------------------------------------------
 void Handler::scanVariable(istringstream & iss){
@@ -127,183 +471,477 @@ void Handler::scanVariable(istringstream & iss){
   size_t rows, cols;
   iss >> var >> rows >> cols;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return;
   }
   if(!isValidVariableName(var)){
-    cout << ILLEGAL_NAME << endl;
+    error(ILLEGAL_NAME);
     return;
   }
-  map<string, Matrix>::iterator it;
-  if((it = vars.find(var)) == vars.end())
-    vars[var] = Matrix(rows, cols);
-  else
-    it->second = Matrix(rows, cols);
   try{
-    cin >> vars.find(var)->second;
-    cout << "Scanning done!" << endl;
+    shared_ptr<Matrix> m = make_shared<Matrix>(rows, cols);
+    *input >> *m;
+    store(var, m);
+    if(verbose)
+      out() << "Scanning done!" << endl;
   }
   catch(const exception & e){
-    cout << e.what() << endl;
-    cin.clear();
-    vars.erase(var);
+    error(e.what());
+    input->clear();
+    erase(var);
   }
 }
 //---------------------------------------------------------------------------------------
 void Handler::deleteVariable(istringstream & iss){
   string var = getNextWord(iss);
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return;
   }
-  const auto & it = vars.find(var);
-  if(it == vars.cend())
-    cout << "Variable '" << var << "' not found!" << endl;
+  if(!erase(var))
+    error("Variable '" + var + "' not found!");
+  else{
+    if(verbose)
+      out() << "Variable '" << var << "' deleted!" << endl;
+  }
+}
+//---------------------------------------------------------------------------------------
+void Handler::setOption(istringstream & iss){
+  string option;
+  size_t value;
+  iss >> option >> value;
+  if(!iss.eof() || iss.fail() || iss.bad()){
+    error(UNKNOWN);
+    return;
+  }
+  transform(option.begin(), option.end(), option.begin(), ::tolower);
+  //cached results could differ with new settings
+  if(option == "blocksize"){
+    Matrix::setBlockSize(value);
+    ResultCache::getInstance().clear();
+  }
+  else if(option == "exact"){
+    Matrix::setExact(value != 0);
+    ResultCache::getInstance().clear();
+  }
+  else if(option == "strassen"){
+    Matrix::setStrassen(value != 0);
+    ResultCache::getInstance().clear();
+  }
+  else if(option == "cache")
+    ResultCache::getInstance().setCapacity(value);
+  else if(option == "workers")
+    ProcessPool::getInstance().start(value);
+  else if(option == "compress"){
+    VariableStore::setIdleTimeout(value);
+    local.startCompressor();
+    shared->startCompressor();
+  }
   else{
-    vars.erase(var);
-    cout << "Variable '" << var << "' deleted!" << endl;
+    error("Unknown option '" + option + "'!");
+    return;
+  }
+  if(verbose)
+    out() << "Option '" << option << "' set!" << endl;
+}
+//---------------------------------------------------------------------------------------
+void Handler::memoryLimit(istringstream & iss){
+  string size = getNextWord(iss);
+  if(getNextWord(iss) != ""){
+    error(UNKNOWN);
+    return;
+  }
+  if(size == ""){
+    size_t limit = VariableStore::getMemoryLimit();
+    out() << "Memory limit: " << (limit ? to_string(limit) + " bytes" : "none") << ", used: "
+          << VariableStore::getMemoryUsed() << " bytes" << endl;
+    return;
+  }
+  size_t digits = 0;
+  while(digits < size.size() && isdigit((unsigned char) size[digits]))
+    ++digits;
+  const string units = "KMGT";
+  size_t unit = digits + 1 == size.size() ? units.find(toupper((unsigned char) size[digits])) : string::npos;
+  size_t shift = unit != string::npos ? 10 * (unit + 1) : 0;
+  size_t bytes = digits == 0 || digits > 15 ? 0 : stoull(size.substr(0, digits));
+  if(digits == 0 || digits > 15 || (shift == 0 && digits < size.size()) || bytes > (SIZE_MAX >> shift)){
+    error("Wrong memory limit '" + size + "'!");
+    return;
   }
+  bytes <<= shift;
+  VariableStore::setMemoryLimit(bytes);
+  local.applyLimit();
+  shared->applyLimit();
+  if(verbose)
+    out() << "Memory limit set!" << endl;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::merge(istringstream & iss, Matrix & m) const{
+void Handler::cache(istringstream & iss){
+  string action = getNextWord(iss);
+  if(!iss.eof() || iss.fail() || iss.bad()){
+    error(UNKNOWN);
+    return;
+  }
+  transform(action.begin(), action.end(), action.begin(), ::tolower);
+  if(action == "stats")
+    ResultCache::getInstance().printStats(out());
+  else if(action == "clear"){
+    ResultCache::getInstance().clear();
+    if(verbose)
+      out() << "Cache cleared!" << endl;
+  }
+  else
+    error(UNKNOWN);
+}
+//---------------------------------------------------------------------------------------
+bool Handler::merge(istringstream & iss, shared_ptr<const Matrix> & m) const{
   string var1, var2;
   iss >> var1 >> var2;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it1 = vars.find(var1);
-  const auto & it2 = vars.find(var2);
-  if(it1 == vars.cend())
-    cout << "Variable '" << var1 << "' not found!" << endl;
-  else if(it2 == vars.cend())
-    cout << "Variable '" << var2 << "' not found!" << endl;
+  size_t v1, v2;
+  shared_ptr<const Matrix> found1 = find(var1, v1);
+  shared_ptr<const Matrix> found2 = find(var2, v2);
+  if(!found1)
+    error("Variable '" + var1 + "' not found!");
+  else if(!found2)
+    error("Variable '" + var2 + "' not found!");
   else{
-    m = it1->second.merge(it2->second);
-    cout << m;
+    m = ResultCache::getInstance().getMatrix("merge " + to_string(v1) + " " + to_string(v2),
+                                            [&]{ return found1->merge(*found2); });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::split(istringstream & iss, Matrix & m) const{
+bool Handler::split(istringstream & iss, shared_ptr<const Matrix> & m) const{
   string var;
   size_t rows, cols, posR, posC;
   iss >> var >> rows >> cols >> posR >> posC;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it = vars.find(var);
-  if(it == vars.cend())
-    cout << "Variable '" << var << "' not found!" << endl;
+  size_t v;
+  shared_ptr<const Matrix> found = find(var, v);
+  if(!found)
+    error("Variable '" + var + "' not found!");
   else{
-    m = it->second.split(rows, cols, posR, posC);
-    cout << m;
+    m = ResultCache::getInstance().getMatrix("split " + to_string(v) + " " + to_string(rows) + " " + to_string(cols)
+                                            + " " + to_string(posR) + " " + to_string(posC),
+                                            [&]{ return found->split(rows, cols, posR, posC); });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
 void Handler::determinant(istringstream & iss) const{
-  Matrix const * tmp;
-  if(getVariable(iss, tmp))
-    cout << tmp->determinant() << endl; 
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v))
+    out() << ResultCache::getInstance().getValue("determinant " + to_string(v), [&]{ return tmp->determinant(); }) << endl;
 }
 //---------------------------------------------------------------------------------------
 void Handler::rank(istringstream & iss) const{
-  Matrix const * tmp;
-  if(getVariable(iss, tmp))
-    cout << tmp->rank() << endl;
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v))
+    out() << (unsigned int) ResultCache::getInstance().getValue("rank " + to_string(v), [&]{ return tmp->rank(); }) << endl;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::transpose(istringstream & iss, Matrix & m) const{
-  Matrix const * tmp;
-  if(getVariable(iss, tmp)){
-    m = tmp->transpose();
-    cout << m;
+bool Handler::transpose(istringstream & iss, shared_ptr<const Matrix> & m) const{
+  //TRANSPOSE var1 op var2 works with transposed view of var1
+  streampos start = iss.tellg();
+  string var, op;
+  iss >> var >> op;
+  if(op == "+" || op == "-" || op == "*")
+    return binaryOperation(var, op, iss, m, true);
+  iss.clear();
+  if(start != streampos(-1))
+    iss.seekg(start);
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v)){
+    m = ResultCache::getInstance().getMatrix("transpose " + to_string(v), [&]{ return tmp->transpose(); });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::inverse(istringstream & iss, Matrix & m) const{
-  Matrix const * tmp;
-  if(getVariable(iss, tmp)){
-    m = tmp->inverse();
-    cout << m;
+bool Handler::inverse(istringstream & iss, shared_ptr<const Matrix> & m) const{
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v)){
+    m = ResultCache::getInstance().getMatrix("inverse " + to_string(v), [&]{ return tmp->inverse(); });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::gem(istringstream & iss, Matrix & m) const{
+bool Handler::gem(istringstream & iss, shared_ptr<const Matrix> & m) const{
   string var, detail;
   iss >> var;
   if(!iss.eof()){
     iss >> detail;
     if(detail != "-v"){
-      cout << UNKNOWN << endl;
+      error(UNKNOWN);
       return false;
     }
   }
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it = vars.find(var);
-  if(it == vars.cend())
-    cout << "Variable '" << var << "' not found!" << endl;
+  size_t v;
+  shared_ptr<const Matrix> found = find(var, v);
+  if(!found)
+    error("Variable '" + var + "' not found!");
   else{
-    m = (detail == "-v" ? it->second.gem(gemStates::DETAILS) : it->second.gem());
-    cout << m;
+    //steps of GEM are printed, so the result cannot be reused
+    if(detail == "-v")
+      m = make_shared<Matrix>(found->gem(gemStates::DETAILS));
+    else
+      m = ResultCache::getInstance().getMatrix("gem " + to_string(v), [&]{ return found->gem(); });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::scalarMultiple(const string & x, istringstream & iss, Matrix & m) const{
+bool Handler::iterativeSettings(istringstream & iss, krylovMethods & method, preconditioners & precond,
+                                double & tolerance, size_t & maxIterations) const{
+  string word = getNextWord(iss);
+  transform(word.begin(), word.end(), word.begin(), ::tolower);
+  if(word == "cg") method = krylovMethods::CG;
+  else if(word == "bicgstab") method = krylovMethods::BICGSTAB;
+  else if(word == "gmres") method = krylovMethods::GMRES;
+  else return false;
+  while(!iss.eof()){
+    word = getNextWord(iss);
+    if(word == "")
+      break;
+    transform(word.begin(), word.end(), word.begin(), ::tolower);
+    size_t pos = word.find('=');
+    if(pos == string::npos)
+      return false;
+    string key = word.substr(0, pos);
+    istringstream value(word.substr(pos + 1));
+    if(key == "tol")
+      value >> tolerance;
+    else if(key == "maxit")
+      value >> maxIterations;
+    else if(key == "precond"){
+      string type = value.str();
+      if(type == "none") precond = preconditioners::NONE;
+      else if(type == "jacobi") precond = preconditioners::JACOBI;
+      else if(type == "ilu0") precond = preconditioners::ILU0;
+      else return false;
+    }
+    else
+      return false;
+    if(value.fail())
+      return false;
+  }
+  return true;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::solve(istringstream & iss, shared_ptr<const Matrix> & m) const{
+  string var1, var2, mode;
+  krylovMethods method = krylovMethods::GMRES;
+  preconditioners precond = preconditioners::NONE;
+  double tolerance = 1e-10;
+  size_t maxIterations = 1000;
+  iss >> var1 >> var2;
+  if(!iss.eof()){
+    iss >> mode;
+    transform(mode.begin(), mode.end(), mode.begin(), ::tolower);
+    if(mode != "iter" || !iterativeSettings(iss, method, precond, tolerance, maxIterations)){
+      error(UNKNOWN);
+      return false;
+    }
+  }
+  if(!iss.eof() || iss.fail() || iss.bad()){
+    error(UNKNOWN);
+    return false;
+  }
+  size_t v1, v2;
+  shared_ptr<const Matrix> found1 = find(var1, v1);
+  shared_ptr<const Matrix> found2 = find(var2, v2);
+  if(!found1)
+    error("Variable '" + var1 + "' not found!");
+  else if(!found2)
+    error("Variable '" + var2 + "' not found!");
+  else if(mode == ""){
+    m = ResultCache::getInstance().getMatrix("solve " + to_string(v1) + " " + to_string(v2),
+                                            [&]{ return found1->solve(*found2); });
+    if(echo())
+      out() << *m;
+    return true;
+  }
+  else{
+    size_t iterations;
+    double residual;
+    m = make_shared<Matrix>(found1->solve(*found2, method, precond, tolerance, maxIterations, iterations, residual));
+    if(echo())
+      out() << (residual <= tolerance ? "Converged" : "Not converged") << " after " << iterations
+           << " iterations, residual " << residual << endl << *m;
+    return true;
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::reorder(istringstream & iss, shared_ptr<const Matrix> & m) const{
+  string var, word;
+  orderings method = orderings::RCM;
+  bool permutation = false;
+  iss >> var;
+  while(!iss.eof()){
+    word = getNextWord(iss);
+    if(word == "")
+      break;
+    transform(word.begin(), word.end(), word.begin(), ::tolower);
+    if(word == "rcm") method = orderings::RCM;
+    else if(word == "nd") method = orderings::NESTED_DISSECTION;
+    else if(word == "perm") permutation = true;
+    else{
+      error(UNKNOWN);
+      return false;
+    }
+  }
+  if(iss.bad() || var == ""){
+    error(UNKNOWN);
+    return false;
+  }
+  size_t v;
+  shared_ptr<const Matrix> found = find(var, v);
+  if(!found){
+    error("Variable '" + var + "' not found!");
+    return false;
+  }
+  string key = "reorder " + to_string(v) + (method == orderings::RCM ? " rcm" : " nd");
+  if(permutation)
+    m = ResultCache::getInstance().getMatrix(key + " perm", [&]{
+      vector<size_t> perm;
+      found->reorder(perm, method);
+      MatrixType * tmp = new DenseMatrix(perm.size(), 1);
+      for(size_t i = 0; i < perm.size(); ++i)
+        tmp->setValue(i, 0, perm[i]);
+      return Matrix(perm.size(), 1, tmp);
+    });
+  else
+    m = ResultCache::getInstance().getMatrix(key, [&]{
+      vector<size_t> perm;
+      return found->reorder(perm, method);
+    });
+  if(echo())
+    out() << *m;
+  return true;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::precision(istringstream & iss, shared_ptr<const Matrix> & m, bool single) const{
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v)){
+    m = ResultCache::getInstance().getMatrix((single ? "float " : "double ") + to_string(v),
+                                            [&]{ return single ? tmp->toSingle() : tmp->toDouble(); });
+    if(echo())
+      out() << *m;
+    return true;
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::binaryField(istringstream & iss, shared_ptr<const Matrix> & m) const{
+  shared_ptr<const Matrix> tmp;
+  size_t v;
+  if(getVariable(iss, tmp, v)){
+    m = ResultCache::getInstance().getMatrix("gf2 " + to_string(v), [&]{ return tmp->toBinary(); });
+    if(echo())
+      out() << *m;
+    return true;
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool Handler::scalarMultiple(const string & x, istringstream & iss, shared_ptr<const Matrix> & m) const{
   string op, var;
   double sc;
   istringstream tmp (x);
   tmp >> sc;
   iss >> op >> var;
   if(!iss.eof() || iss.fail() || iss.bad() || op != "*"){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it = vars.find(var);
-  if(it == vars.cend())
-    cout << "Variable '" << var << "' not found!" << endl;
+  size_t v;
+  shared_ptr<const Matrix> found = find(var, v);
+  if(!found)
+    error("Variable '" + var + "' not found!");
   else{
-    m = sc * it->second;
-    cout << m;
+    m = ResultCache::getInstance().getMatrix("scalar " + x + " " + to_string(v), [&]{ return sc * *found; });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::binaryOperation(const string & var1, const string & op, istringstream & iss, Matrix & m) const{
+bool Handler::binaryOperation(const string & var1, const string & op, istringstream & iss, shared_ptr<const Matrix> & m,
+                              bool transposed1) const{
   string var2;
   iss >> var2;
+  string word = var2;
+  transform(word.begin(), word.end(), word.begin(), ::tolower);
+  bool transposed2 = word == "transpose" && !transposed1 && !iss.eof();
+  if(transposed2)
+    iss >> var2;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  const auto & it1 = vars.find(var1);
-  const auto & it2 = vars.find(var2);
-  if(it1 == vars.cend())
-    cout << "Variable '" << var1 << "' not found!" << endl;
-  else if(it2 == vars.cend())
-    cout << "Variable '" << var2 << "' not found!" << endl;
+  size_t v1, v2;
+  shared_ptr<const Matrix> found1 = find(var1, v1);
+  shared_ptr<const Matrix> found2 = find(var2, v2);
+  if(!found1)
+    error("Variable '" + var1 + "' not found!");
+  else if(!found2)
+    error("Variable '" + var2 + "' not found!");
   else{
-    if(op == "+")
-      m = it1->second + it2->second;
-    else if(op == "-")
-      m = it1->second - it2->second;
-    else
-      m = it1->second * it2->second;
-    cout << m;
+    string key = "binary " + to_string(v1) + (transposed1 ? "T " : " ") + op + " " + to_string(v2) + (transposed2 ? "T" : "");
+    m = ResultCache::getInstance().getMatrix(key, [&]{
+      if(transposed1){
+        if(op == "+")
+          return *found2 + found1->transposed();
+        else if(op == "-")
+          return -1 * (*found2 - found1->transposed());
+        return found1->transposed() * *found2;
+      }
+      if(transposed2){
+        if(op == "+")
+          return *found1 + found2->transposed();
+        else if(op == "-")
+          return *found1 - found2->transposed();
+        return *found1 * found2->transposed();
+      }
+      if(op == "+")
+        return *found1 + *found2;
+      else if(op == "-")
+        return *found1 - *found2;
+      return *found1 * *found2;
+    });
+    if(echo())
+      out() << *m;
     return true;
   }
   return false;
@@ -312,7 +950,36 @@ bool Handler::binaryOperation(const string & var1, const string & op, istringstr
 bool Handler::equalToVariable(istringstream & iss){
   string var1, var2, op;
   iss >> var1 >> op >> var2;
-  return (vars.find(var2) != vars.end() && iss.eof() && !iss.bad() && !iss.fail());
+  return (find(var2) && iss.eof() && !iss.bad() && !iss.fail());
+}
+//---------------------------------------------------------------------------------------
+bool Handler::compoundAssignment(istringstream & iss, shared_ptr<const Matrix> & m){
+  string var, eq, first, op, second;
+  iss >> var >> eq >> first >> op >> second;
+  if(!iss.eof() || iss.fail() || iss.bad())
+    return false;
+  bool scalar = op == "*" && second == var && isDouble(first);
+  if(!scalar && (first != var || (op != "+" && op != "-")))
+    return false;
+  shared_ptr<const Matrix> other;
+  double x = 0;
+  if(scalar)
+    istringstream(first) >> x;
+  else if(!(other = find(second)))
+    return false;
+  m = update(var, [&](Matrix & a){
+    if(scalar)
+      a *= x;
+    else if(op == "+")
+      a += *other;
+    else
+      a -= *other;
+  });
+  if(!m)
+    return false;
+  if(echo())
+    out() << *m;
+  return true;
 }
 //---------------------------------------------------------------------------------------
 bool Handler::addNewMatrix(const string & var, const string & rows, istringstream & iss){
@@ -324,36 +991,40 @@ bool Handler::addNewMatrix(const string & var, const string & rows, istringstrea
   if(!iss.eof())
     iss >> diag;
   if(!iss.eof() || iss.fail() || iss.bad()){
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
     return false;
   }
-  vars[var] = Matrix(r, c);
-  vars[var] = diag; 
+  shared_ptr<Matrix> m = make_shared<Matrix>(r, c);
+  *m = diag;
+  store(var, m);
   return true;
 }
 //---------------------------------------------------------------------------------------
-bool Handler::variableOperation(const string & var, istringstream & iss, Matrix & m){
+bool Handler::variableOperation(const string & var, istringstream & iss, shared_ptr<const Matrix> & m){
   string next = getNextWord(iss);
   if(!iss.good())
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
   else if(next == "+" || next == "-" || next == "*")
     return binaryOperation(var, next, iss, m);
   else if(isDouble(next))
     return addNewMatrix(var, next, iss);
   else if(next == "="){
-    istringstream iss2(iss.str());
+    current->assigning = true;
+    istringstream iss2(iss.str()), iss3(iss.str());
+    if(compoundAssignment(iss3, m))
+      return true;
     if(equalToVariable(iss2)){
       iss >> next;
-      vars[var] = vars[next];
+      store(var, find(next));
       return true;
     }
     if(parse(iss, m)){
-      vars[var] = m;
+      store(var, m);
       return true;
     }
     return false;
   }
   else
-    cout << UNKNOWN << endl;
+    error(UNKNOWN);
   return false;
 }
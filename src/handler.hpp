@@ -3,17 +3,65 @@
 
 #include <string>
 #include <map>
+#include <set>
+#include <deque>
+#include <vector>
 #include <sstream>
 #include <algorithm>
 #include <exception>
+#include <iostream>
 #include "matrix.hpp"
+#include "variableStore.hpp"
 
 /**
   * @brief Handler of user input.
   */
 class Handler{
   private:
-    std::map<std::string, Matrix> vars; ///< All stored variables.
+    /**
+      * @brief Change of variable made by a command which runs together with others.
+      */
+    struct Change{
+      std::string var; ///< Variable name.
+      std::shared_ptr<const Matrix> matrix; ///< New matrix, empty pointer deletes variable.
+      size_t version; ///< Version under which later commands of window read the matrix.
+    };
+
+    /**
+      * @brief One command with its own output and error.
+      * Independent commands of a script run at once, their output is kept here and
+      * printed later in the original order.
+      */
+    struct Command{
+      std::string text; ///< Command.
+      size_t line = 0; ///< Line of script where command starts.
+      std::set<std::string> reads, ///< Names which command may read.
+                            writes; ///< Names which command may change.
+      std::ostringstream output; ///< Output kept until earlier commands are printed.
+      std::ostream * out = NULL; ///< Stream for output of command.
+      bool script = false; ///< Whether command comes from a script.
+      bool assigning = false; ///< Whether command is an assignment.
+      bool failed = false; ///< Whether command failed.
+      bool exit = false; ///< Whether command was exit.
+      std::string error; ///< First error of command.
+      bool deferred = false; ///< Whether changes of variables are kept until the window ends.
+      std::vector<Change> changes; ///< Kept changes of variables in the order they were made.
+      std::vector<const Command *> before; ///< Earlier commands of window which command conflicts with.
+    };
+
+    std::shared_ptr<VariableStore> shared; ///< Variables shared with other handlers.
+    VariableStore local; ///< Private variables of this handler.
+    std::istream * input; ///< Stream from which SCAN reads matrices.
+    std::ostream * output; ///< Stream for results.
+    std::ostream * errors; ///< Stream for errors of scripts and runtime.
+    bool verbose = true; ///< Whether results of assignments and status messages are printed.
+    size_t depth = 0; ///< Number of scripts being run.
+    static thread_local Command * current; ///< Command run by this thread.
+
+    /// Maximum number of nested scripts.
+    static const size_t MAX_DEPTH;
+    /// Maximum number of script commands scheduled together.
+    static const size_t WINDOW;
 
     /// Information for user that no variables are stored.
     static const std::string NO_VARS;
@@ -43,15 +91,136 @@ class Handler{
       * @return true if is valid name and false otherwise
       */
     bool isValidVariableName(const std::string & var) const;
+    /**
+      * @brief Handles command.
+      * @param input command
+      * @return false if exit was typed true otherwise
+      */
+    bool dispatch(const std::string & input);
+    /**
+      * @brief Runs command and catches its errors.
+      * @param command command
+      */
+    void runCommand(Command & command);
+    /**
+      * @brief Finds names which command reads and changes.
+      * Every word of command is taken as a read name and every word followed by
+      * <b>=</b> or by a number as a changed name. Commands which read input, change
+      * settings, delete or list variables or print details of GEM must run alone.
+      * @param text command
+      * @param[out] reads names which command may read
+      * @param[out] writes names which command may change
+      * @return true if command can run together with other commands otherwise false
+      */
+    bool analyze(const std::string & text, std::set<std::string> & reads, std::set<std::string> & writes) const;
+    /**
+      * @brief Tells whether two commands must run in the original order.
+      * @param a first command
+      * @param b second command
+      * @return true if one of commands changes a name which the other one uses
+      */
+    static bool conflict(const Command & a, const Command & b);
+    /**
+      * @brief Runs commands of script and prints their output in the original order.
+      * Every command runs after all earlier commands which it conflicts with. Commands
+      * which do not depend on each other run at once on ThreadPool. Their changes of
+      * variables are kept and made in the original order when all commands finished, up
+      * to the first failed command, so later commands change nothing. Window is emptied.
+      * @param window commands
+      * @param file name of script
+      * @param[out] ok set to false if a command failed
+      * @return false if script should stop otherwise true
+      */
+    bool flush(std::deque<Command> & window, const std::string & file, bool & ok);
+    /**
+      * @brief Finds change of variable kept by current command or by earlier commands
+      * which it conflicts with.
+      * @param var variable name
+      * @return the last kept change or NULL if variable was not changed
+      */
+    const Change * findChange(const std::string & var) const;
+    /**
+      * @brief Returns stream for output of current command.
+      * Output of handler is used outside of any command, e.g. when script cannot be opened.
+      * @return output stream
+      */
+    std::ostream & out() const;
+    /**
+      * @brief Reports error.
+      * Error is printed at once in interactive mode. While a script is run, the first
+      * error of the command is remembered and the script stops after the command.
+      * Outside of any command the error is printed at once too.
+      * @param message error message
+      */
+    void error(const std::string & message) const;
+    /**
+      * @brief Tells whether variable is private to this handler.
+      * Names of private variables start with <b>_</b>.
+      * @param var variable name
+      * @return true if variable is private otherwise false
+      */
+    static bool isPrivate(const std::string & var);
+    /**
+      * @brief Finds variable.
+      * @param var variable name
+      * @return snapshot of variable or empty pointer if there is no such variable
+      */
+    std::shared_ptr<const Matrix> find(const std::string & var) const;
+    /**
+      * @brief Finds variable and its version.
+      * @param var variable name
+      * @param[out] version version of variable
+      * @return snapshot of variable or empty pointer if there is no such variable
+      */
+    std::shared_ptr<const Matrix> find(const std::string & var, size_t & version) const;
+    /**
+      * @brief Stores matrix to variable.
+      * Change of command which runs together with others is only kept.
+      * @param var variable name
+      * @param m matrix
+      */
+    void store(const std::string & var, const std::shared_ptr<const Matrix> & m);
+    /**
+      * @brief Changes variable in place.
+      * @throw MatrixException
+      * @param var variable name
+      * @param change change of matrix
+      * @return snapshot of changed variable or empty pointer if there is no such variable
+      * @sa VariableStore::update
+      */
+    std::shared_ptr<const Matrix> update(const std::string & var, const std::function<void(Matrix &)> & change);
+    /**
+      * @brief Deletes variable.
+      * @param var variable name
+      * @return true if variable was deleted otherwise false
+      */
+    bool erase(const std::string & var);
+    /**
+      * @brief Tells whether result of current command should be printed.
+      * Results of assignments are printed only in verbose mode.
+      * @return true if result should be printed otherwise false
+      */
+    bool echo() const;
+    /**
+      * @brief Runs script which name and optional <b>-v</b> are in <i>iss</i>.
+      * @param iss input string stream
+      * @sa run
+      */
+    void runScript(std::istringstream & iss);
     /**
       * @brief Prints help
       */
     void printHelp() const;
     /**
       * @brief Prints names of all variables.
-      * If no variables are stored then function prints "No variables stored!".
+      * If no variables are stored then function prints "No variables stored!". With
+      * <b>-v</b> every variable is printed on its own line with dimensions, storage,
+      * number of non-zero elements, counted bytes and whether it is compressed or
+      * spilled, followed by bytes of all stores and the memory limit.
+      * @param iss input string stream
+      * @sa VariableStore::getInfo
       */
-    void listVariables() const;
+    void listVariables(std::istringstream & iss) const;
     /**
       * @brief Prints variable which name is in <i>iss</i>.
       * If there is not any variable with such a name then information is printed.
@@ -71,6 +240,33 @@ class Handler{
       */
     void scanVariable(std::istringstream & iss);
 
+    /**
+      * @brief Sets option which name and value are in <i>iss</i>.
+      * Known options are <b>blocksize</b> (panel width of blocked LU factorization),
+      * <b>exact</b> (1 or 0, exact rank and determinant of integer matrices),
+      * <b>strassen</b> (1 or 0, Strassen-Winograd multiplication of big dense matrices),
+      * <b>cache</b> (maximum number of cached results, 0 turns caching off),
+      * <b>workers</b> (number of worker processes for big products) and <b>compress</b>
+      * (seconds after which unused variables are compressed, 0 turns it off).
+      * Changing blocksize, exact or strassen drops cached results.
+      * @param iss input string stream
+      * @sa Matrix::setBlockSize, Matrix::setExact, Matrix::setStrassen, ResultCache::setCapacity,
+      * ProcessPool::start, VariableStore::setIdleTimeout
+      */
+    void setOption(std::istringstream & iss);
+    /**
+      * @brief Sets memory limit of variables from <i>iss</i> or prints it.
+      * Limit is a number of bytes with optional suffix K, M, G or T, 0 means no limit.
+      * @param iss input string stream
+      * @sa VariableStore::setMemoryLimit
+      */
+    void memoryLimit(std::istringstream & iss);
+    /**
+      * @brief Prints statistics of ResultCache (<b>STATS</b>) or clears it (<b>CLEAR</b>).
+      * @param iss input string stream
+      */
+    void cache(std::istringstream & iss);
+
     /**
       * @brief Merges matrices and prints result.
       * @param iss input string stream
@@ -78,7 +274,7 @@ class Handler{
       * @return true if successful merging otherwise false
       * @sa Matrix::merge
       */
-    bool merge(std::istringstream & iss, Matrix & m) const;
+    bool merge(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
     /**
       * @brief Splits matrix from bigger matrix and prints result.
       * @param iss input string stream
@@ -86,7 +282,7 @@ class Handler{
       * @return true if successful splitting otherwise false
       * @sa Matrix::split
       */
-    bool split(std::istringstream & iss, Matrix & m) const;
+    bool split(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
     /**
       * @brief Calculates determinant of matrix.
       * @param iss input string stream
@@ -101,12 +297,13 @@ class Handler{
     void rank(std::istringstream & iss) const;
     /**
       * @brief Transposes matrix and prints result.
+      * TRANSPOSE var1 op var2 is passed to binaryOperation with transposed first variable.
       * @param iss input string stream
       * @param[out] m transposed matrix
       * @return true if successful transpose otherwise false
       * @sa Matrix::transpose
       */
-    bool transpose(std::istringstream & iss, Matrix & m) const;
+    bool transpose(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
     /**
       * @brief Inverts matrix and prints result.
       * @param iss input string stream
@@ -114,7 +311,7 @@ class Handler{
       * @return true if successful inversion otherwise false
       * @sa Matrix::inverse
       */
-    bool inverse(std::istringstream & iss, Matrix & m) const;
+    bool inverse(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
     /**
       * @brief Performs GEM on matrix and prints result.
       * @param iss input string stream
@@ -122,7 +319,59 @@ class Handler{
       * @return true if successful GEM otherwise false
       * @sa Matrix::gem
       */
-    bool gem(std::istringstream & iss, Matrix & m) const;
+    bool gem(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
+    /**
+      * @brief Reads settings of iterative solver.
+      * Settings are method (<b>cg</b>, <b>bicgstab</b> or <b>gmres</b>) followed by
+      * optional <b>tol=</b>x, <b>maxit=</b>n and <b>precond=</b>(<b>none</b>,
+      * <b>jacobi</b> or <b>ilu0</b>).
+      * @param iss input string stream
+      * @param[out] method iterative method
+      * @param[out] precond preconditioner
+      * @param[out] tolerance required relative residual
+      * @param[out] maxIterations maximum number of iterations
+      * @return true if settings are valid otherwise false
+      */
+    bool iterativeSettings(std::istringstream & iss, krylovMethods & method, preconditioners & precond,
+                           double & tolerance, size_t & maxIterations) const;
+    /**
+      * @brief Solves system of linear equations and prints result.
+      * System is solved directly or, if the keyword <b>ITER</b> follows, by an
+      * iterative method.
+      * @param iss input string stream
+      * @param[out] m solution
+      * @return true if successful solving otherwise false
+      * @sa Matrix::solve
+      */
+    bool solve(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
+    /**
+      * @brief Reorders rows and columns of matrix and prints result.
+      * Method <b>RCM</b> (default) or <b>ND</b> may follow the variable. With the word
+      * <b>PERM</b> the result is the permutation as a column vector of 0-based indices,
+      * otherwise it is the reordered matrix.
+      * @param iss input string stream
+      * @param[out] m reordered matrix or permutation
+      * @return true if successful reordering otherwise false
+      * @sa Matrix::reorder
+      */
+    bool reorder(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
+    /**
+      * @brief Converts matrix to single or double precision and prints result.
+      * @param iss input string stream
+      * @param[out] m converted matrix
+      * @param single single precision
+      * @return true if successful conversion otherwise false
+      * @sa Matrix::toSingle, Matrix::toDouble
+      */
+    bool precision(std::istringstream & iss, std::shared_ptr<const Matrix> & m, bool single) const;
+    /**
+      * @brief Converts integer matrix to GF(2) and prints result.
+      * @param iss input string stream
+      * @param[out] m converted matrix
+      * @return true if successful conversion otherwise false
+      * @sa Matrix::toBinary
+      */
+    bool binaryField(std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
     /**
       * @brief Scalar multiplication of matrix.
       * @param x scalar
@@ -130,18 +379,22 @@ class Handler{
       * @param[out] m multiplied matrix
       * @return true if successful multiplication otherwise false
       */
-    bool scalarMultiple(const std::string & x, std::istringstream & iss, Matrix & m) const;
+    bool scalarMultiple(const std::string & x, std::istringstream & iss, std::shared_ptr<const Matrix> & m) const;
 
      /**
       * @brief Binary operation between two variables.
-      * Can be sum, difference or multiplication.
+      * Can be sum, difference or multiplication. One of variables can be transposed,
+      * second one by the word TRANSPOSE before it. Transposed variable is used through
+      * Matrix::transposed view, so it is not copied.
       * @param var1 first variable
       * @param op operator
       * @param iss input string stream
       * @param[out] m matrix
+      * @param transposed1 first variable is transposed
       * @return true if successful operation otherwise false
       */
-    bool binaryOperation(const std::string & var1, const std::string & op, std::istringstream & iss, Matrix & m) const;
+    bool binaryOperation(const std::string & var1, const std::string & op, std::istringstream & iss, std::shared_ptr<const Matrix> & m,
+                         bool transposed1 = false) const;
     /**
      * @brief Operator = for variables.
      * @param var first variable
@@ -149,7 +402,7 @@ class Handler{
      * @param[out] m matrix
      * @return true if successful operation otherwise false
      */
-    bool variableOperation(const std::string & var, std::istringstream & iss, Matrix & m);
+    bool variableOperation(const std::string & var, std::istringstream & iss, std::shared_ptr<const Matrix> & m);
      /**
       * @brief Adds new variable.
       * @param var variable name
@@ -163,32 +416,64 @@ class Handler{
       * @param iss input string stream
       * @param[out] m new matrix
       */
-    bool parse(std::istringstream & iss, Matrix & m);
+    bool parse(std::istringstream & iss, std::shared_ptr<const Matrix> & m);
     /**
       * @brief var1 = var2
       * @param iss input string stream
       * @return true if successful operation otherwise false
       */
     bool equalToVariable(std::istringstream & iss);
+    /**
+      * @brief var = var + var2, var = var - var2 and var = x * var in place.
+      * Matrix of var is changed by Matrix::operator +=, Matrix::operator -= or scalar
+      * operator *=, so no new matrix is made.
+      * @param iss input string stream
+      * @param[out] m changed matrix
+      * @return true if the command has one of these forms and both variables exist,
+      * otherwise false and nothing is done
+      */
+    bool compoundAssignment(std::istringstream & iss, std::shared_ptr<const Matrix> & m);
     /**
       * @brief Finds variable or prints not found.
       * @param iss input string stream
       * @param[out] m variable
+      * @param[out] version version of variable
       * @return true if found otherwise false
       */
-    bool getVariable(std::istringstream & iss, Matrix const * & m) const;
+    bool getVariable(std::istringstream & iss, std::shared_ptr<const Matrix> & m, size_t & version) const;
 
   public:
     /**
-      * @brief Default constructor.
+      * @brief Constructs handler.
+      * Handlers constructed with the same <i>shared</i> store see the same variables
+      * except private ones.
+      * @param input stream from which SCAN reads matrices
+      * @param output stream for results
+      * @param errors stream for errors of scripts and runtime
+      * @param shared shared variables
       */
-    Handler() = default;
+    Handler(std::istream & input = std::cin, std::ostream & output = std::cout, std::ostream & errors = std::cerr,
+            const std::shared_ptr<VariableStore> & shared = std::make_shared<VariableStore>());
     /**
       * @brief Handles new command.
       * @param input user input
       * @return false if exit was typed true otherwise
       */
     bool execute(const std::string & input);
+    /**
+      * @brief Runs commands from file.
+      * File is read into memory at once and SCAN reads matrices from it too. Commands
+      * which use different variables run concurrently, output is the same as if they
+      * ran one by one. Script stops at the first error, which is printed to standard
+      * error with file name and line number, or at command exit. Variables changed by
+      * commands after the failed one may already be changed. Results of assignments
+      * and status messages are printed only in verbose mode. Total runtime is printed to
+      * standard error.
+      * @param file name of file
+      * @param verbose print results of assignments and status messages
+      * @return true if script ran without errors otherwise false
+      */
+    bool run(const std::string & file, bool verbose);
 };
 
 #endif /* HANDLER_HPP */
@@ -0,0 +1,300 @@
+#include "iterativeSolver.hpp"
+#include "threadPool.hpp"
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+const size_t IterativeSolver::PARALLEL_ROWS = 20000;
+const size_t IterativeSolver::RESTART = 30;
+
+namespace{
+  const size_t NONE = numeric_limits<size_t>::max(); ///< Missing position.
+
+  /**
+    * @brief Returns dot product of two vectors.
+    */
+  double dot(const vector<double> & x, const vector<double> & y){
+    double sum = 0;
+    for(size_t i = 0; i < x.size(); ++i)
+      sum += x[i] * y[i];
+    return sum;
+  }
+
+  /**
+    * @brief Returns Euclidean norm of a vector.
+    */
+  double norm(const vector<double> & x){
+    return sqrt(dot(x, x));
+  }
+}
+
+IterativeSolver::IterativeSolver(const MatrixType & matrix, krylovMethods method, preconditioners type,
+                                 double tolerance, size_t maxIterations)
+  : n(matrix.getRows()), rowStart(n + 1, 0), diagPos(n, NONE), method(method), type(type),
+    tolerance(tolerance), maxIterations(maxIterations){
+  if(matrix.getRows() != matrix.getCols())
+    throw MatrixException("Wrong dimensions!");
+  //elements are visited row by row, so counts of rows make starts of rows
+  matrix.forEachNonZero([this](size_t i, size_t j, double x){
+    ++rowStart[i + 1];
+    colIndex.push_back(j);
+    values.push_back(x);
+  });
+  for(size_t i = 0; i < n; ++i)
+    rowStart[i + 1] += rowStart[i];
+  for(size_t i = 0; i < n; ++i)
+    for(size_t p = rowStart[i]; p < rowStart[i + 1]; ++p)
+      if(colIndex[p] == i)
+        diagPos[i] = p;
+  buildPreconditioner();
+}
+//---------------------------------------------------------------------------------------
+void IterativeSolver::buildPreconditioner(){
+  if(type == preconditioners::NONE)
+    return;
+  for(size_t i = 0; i < n; ++i)
+    if(diagPos[i] == NONE)
+      throw MatrixException("Zero on diagonal!");
+  if(type == preconditioners::JACOBI){
+    precond.resize(n);
+    for(size_t i = 0; i < n; ++i)
+      precond[i] = 1 / values[diagPos[i]];
+    return;
+  }
+  //ILU(0) keeps only elements on positions of non-zero elements of the matrix
+  precond = values;
+  vector<size_t> pos(n, NONE);
+  for(size_t i = 0; i < n; ++i){
+    for(size_t p = rowStart[i]; p < rowStart[i + 1]; ++p)
+      pos[colIndex[p]] = p;
+    for(size_t p = rowStart[i]; p < diagPos[i]; ++p){
+      size_t k = colIndex[p];
+      precond[p] /= precond[diagPos[k]];
+      for(size_t q = diagPos[k] + 1; q < rowStart[k + 1]; ++q)
+        if(pos[colIndex[q]] != NONE)
+          precond[pos[colIndex[q]]] -= precond[p] * precond[q];
+    }
+    if(precond[diagPos[i]] == 0)
+      throw MatrixException("Zero pivot in ILU(0)!");
+    for(size_t p = rowStart[i]; p < rowStart[i + 1]; ++p)
+      pos[colIndex[p]] = NONE;
+  }
+}
+//---------------------------------------------------------------------------------------
+void IterativeSolver::multiply(const vector<double> & x, vector<double> & y) const{
+  y.resize(n);
+  auto rows = [&](size_t begin, size_t end){
+    for(size_t i = begin; i < end; ++i){
+      double sum = 0;
+      for(size_t p = rowStart[i]; p < rowStart[i + 1]; ++p)
+        sum += values[p] * x[colIndex[p]];
+      y[i] = sum;
+    }
+  };
+  if(n < PARALLEL_ROWS)
+    rows(0, n);
+  else
+    ThreadPool::getInstance().parallelFor(n, rows);
+}
+//---------------------------------------------------------------------------------------
+void IterativeSolver::apply(const vector<double> & v, vector<double> & z) const{
+  z.resize(n);
+  if(type == preconditioners::NONE){
+    z = v;
+    return;
+  }
+  if(type == preconditioners::JACOBI){
+    for(size_t i = 0; i < n; ++i)
+      z[i] = precond[i] * v[i];
+    return;
+  }
+  //forward substitution with unit lower triangular L
+  for(size_t i = 0; i < n; ++i){
+    double sum = v[i];
+    for(size_t p = rowStart[i]; p < diagPos[i]; ++p)
+      sum -= precond[p] * z[colIndex[p]];
+    z[i] = sum;
+  }
+  //back substitution with upper triangular U
+  for(size_t i = n; i-- > 0;){
+    double sum = z[i];
+    for(size_t p = diagPos[i] + 1; p < rowStart[i + 1]; ++p)
+      sum -= precond[p] * z[colIndex[p]];
+    z[i] = sum / precond[diagPos[i]];
+  }
+}
+//---------------------------------------------------------------------------------------
+bool IterativeSolver::solve(const vector<double> & b, vector<double> & x){
+  iterations = 0;
+  x.resize(n, 0);
+  if(norm(b) == 0){
+    fill(x.begin(), x.end(), 0);
+    residual = 0;
+    return true;
+  }
+  if(method == krylovMethods::CG)
+    return cg(b, x);
+  if(method == krylovMethods::BICGSTAB)
+    return bicgstab(b, x);
+  return gmres(b, x);
+}
+//---------------------------------------------------------------------------------------
+bool IterativeSolver::cg(const vector<double> & b, vector<double> & x){
+  double bNorm = norm(b);
+  vector<double> r, z, p, ap;
+  multiply(x, r);
+  for(size_t i = 0; i < n; ++i)
+    r[i] = b[i] - r[i];
+  if((residual = norm(r) / bNorm) <= tolerance)
+    return true;
+  apply(r, z);
+  p = z;
+  double rz = dot(r, z);
+  while(iterations < maxIterations){
+    ++iterations;
+    multiply(p, ap);
+    double alpha = rz / dot(p, ap);
+    for(size_t i = 0; i < n; ++i){
+      x[i] += alpha * p[i];
+      r[i] -= alpha * ap[i];
+    }
+    if((residual = norm(r) / bNorm) <= tolerance)
+      return true;
+    apply(r, z);
+    double rzNew = dot(r, z);
+    double beta = rzNew / rz;
+    rz = rzNew;
+    for(size_t i = 0; i < n; ++i)
+      p[i] = z[i] + beta * p[i];
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool IterativeSolver::bicgstab(const vector<double> & b, vector<double> & x){
+  double bNorm = norm(b);
+  vector<double> r, rHat, p(n, 0), v(n, 0), pHat, s(n), sHat, t;
+  multiply(x, r);
+  for(size_t i = 0; i < n; ++i)
+    r[i] = b[i] - r[i];
+  if((residual = norm(r) / bNorm) <= tolerance)
+    return true;
+  rHat = r;
+  double rho = 1, alpha = 1, omega = 1;
+  while(iterations < maxIterations){
+    ++iterations;
+    double rhoNew = dot(rHat, r);
+    if(rhoNew == 0)
+      return false;
+    double beta = (rhoNew / rho) * (alpha / omega);
+    rho = rhoNew;
+    for(size_t i = 0; i < n; ++i)
+      p[i] = r[i] + beta * (p[i] - omega * v[i]);
+    apply(p, pHat);
+    multiply(pHat, v);
+    alpha = rho / dot(rHat, v);
+    for(size_t i = 0; i < n; ++i)
+      s[i] = r[i] - alpha * v[i];
+    if((residual = norm(s) / bNorm) <= tolerance){
+      for(size_t i = 0; i < n; ++i)
+        x[i] += alpha * pHat[i];
+      return true;
+    }
+    apply(s, sHat);
+    multiply(sHat, t);
+    omega = dot(t, s) / dot(t, t);
+    for(size_t i = 0; i < n; ++i){
+      x[i] += alpha * pHat[i] + omega * sHat[i];
+      r[i] = s[i] - omega * t[i];
+    }
+    if((residual = norm(r) / bNorm) <= tolerance)
+      return true;
+    if(omega == 0)
+      return false;
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+bool IterativeSolver::gmres(const vector<double> & b, vector<double> & x){
+  double bNorm = norm(b);
+  vector<double> r, w, z;
+  multiply(x, r);
+  for(size_t i = 0; i < n; ++i)
+    r[i] = b[i] - r[i];
+  double beta = norm(r);
+  if((residual = beta / bNorm) <= tolerance)
+    return true;
+  while(iterations < maxIterations){
+    //Arnoldi process with Givens rotations
+    vector<vector<double> > basis(1, r);
+    vector<vector<double> > h(RESTART + 1, vector<double>(RESTART, 0));
+    vector<double> g(RESTART + 1, 0), cs(RESTART), sn(RESTART);
+    for(size_t i = 0; i < n; ++i)
+      basis[0][i] /= beta;
+    g[0] = beta;
+    size_t k = 0;
+    while(k < RESTART && iterations < maxIterations){
+      ++iterations;
+      apply(basis[k], z);
+      multiply(z, w);
+      for(size_t i = 0; i <= k; ++i){
+        h[i][k] = dot(w, basis[i]);
+        for(size_t j = 0; j < n; ++j)
+          w[j] -= h[i][k] * basis[i][j];
+      }
+      h[k + 1][k] = norm(w);
+      bool breakdown = h[k + 1][k] == 0;
+      if(!breakdown){
+        for(size_t j = 0; j < n; ++j)
+          w[j] /= h[k + 1][k];
+        basis.push_back(w);
+      }
+      for(size_t i = 0; i < k; ++i){
+        double tmp = cs[i] * h[i][k] + sn[i] * h[i + 1][k];
+        h[i + 1][k] = -sn[i] * h[i][k] + cs[i] * h[i + 1][k];
+        h[i][k] = tmp;
+      }
+      double d = hypot(h[k][k], h[k + 1][k]);
+      cs[k] = h[k][k] / d;
+      sn[k] = h[k + 1][k] / d;
+      h[k][k] = d;
+      h[k + 1][k] = 0;
+      g[k + 1] = -sn[k] * g[k];
+      g[k] *= cs[k];
+      ++k;
+      residual = fabs(g[k]) / bNorm;
+      if(residual <= tolerance || breakdown)
+        break;
+    }
+    //x += inverse(M) * V * y where H * y = g
+    vector<double> y(k);
+    for(size_t i = k; i-- > 0;){
+      double sum = g[i];
+      for(size_t j = i + 1; j < k; ++j)
+        sum -= h[i][j] * y[j];
+      y[i] = sum / h[i][i];
+    }
+    vector<double> update(n, 0);
+    for(size_t i = 0; i < k; ++i)
+      for(size_t j = 0; j < n; ++j)
+        update[j] += y[i] * basis[i][j];
+    apply(update, z);
+    for(size_t i = 0; i < n; ++i)
+      x[i] += z[i];
+    multiply(x, r);
+    for(size_t i = 0; i < n; ++i)
+      r[i] = b[i] - r[i];
+    beta = norm(r);
+    if((residual = beta / bNorm) <= tolerance)
+      return true;
+  }
+  return false;
+}
+//---------------------------------------------------------------------------------------
+size_t IterativeSolver::getIterations() const{
+  return iterations;
+}
+//---------------------------------------------------------------------------------------
+double IterativeSolver::getResidual() const{
+  return residual;
+}
@@ -0,0 +1,108 @@
+#ifndef ITERATIVESOLVER_HPP
+#define ITERATIVESOLVER_HPP
+
+#include <vector>
+#include "matrixType.hpp"
+
+enum class krylovMethods{CG, BICGSTAB, GMRES}; ///< Iterative method.
+enum class preconditioners{NONE, JACOBI, ILU0}; ///< Preconditioner of iterative method.
+
+/**
+  * @brief Solves systems of linear equations by Krylov subspace methods.
+  *
+  * Matrix is copied to compressed sparse rows once, so every iteration needs only
+  * matrix-vector products which cost O(nnz). Products of large matrices are split
+  * between threads of ThreadPool. Supported methods are conjugate gradients
+  * (symmetric positive definite matrices), BiCGSTAB and restarted GMRES, each of them
+  * with Jacobi or ILU(0) preconditioner.
+  */
+class IterativeSolver{
+  private:
+    size_t n; ///< Dimension.
+    std::vector<size_t> rowStart, ///< Position of the first element of every row.
+                        colIndex, ///< Column of every element.
+                        diagPos; ///< Position of diagonal element of every row.
+    std::vector<double> values, ///< Value of every element.
+                        precond; ///< Jacobi inverse of diagonal or ILU(0) factors.
+    krylovMethods method; ///< Method.
+    preconditioners type; ///< Preconditioner.
+    double tolerance; ///< Required relative residual.
+    size_t maxIterations; ///< Maximum number of iterations.
+    size_t iterations = 0; ///< Iterations done by the last solve.
+    double residual = 0; ///< Relative residual reached by the last solve.
+
+    /// Matrices with fewer rows are multiplied by one thread.
+    static const size_t PARALLEL_ROWS;
+    /// Number of iterations of GMRES before restart.
+    static const size_t RESTART;
+
+    /**
+      * @brief Computes y = Ax.
+      * @param x vector
+      * @param[out] y product
+      */
+    void multiply(const std::vector<double> & x, std::vector<double> & y) const;
+    /**
+      * @brief Computes z = inverse(M) * v where M is preconditioner.
+      * @param v vector
+      * @param[out] z preconditioned vector
+      */
+    void apply(const std::vector<double> & v, std::vector<double> & z) const;
+    /**
+      * @brief Builds preconditioner.
+      * @throw MatrixException
+      */
+    void buildPreconditioner();
+    /**
+      * @brief Preconditioned conjugate gradients.
+      * @param b right-hand side
+      * @param[in, out] x initial guess and solution
+      * @return true if converged otherwise false
+      */
+    bool cg(const std::vector<double> & b, std::vector<double> & x);
+    /**
+      * @brief Right preconditioned BiCGSTAB.
+      * @param b right-hand side
+      * @param[in, out] x initial guess and solution
+      * @return true if converged otherwise false
+      */
+    bool bicgstab(const std::vector<double> & b, std::vector<double> & x);
+    /**
+      * @brief Right preconditioned GMRES restarted after RESTART iterations.
+      * @param b right-hand side
+      * @param[in, out] x initial guess and solution
+      * @return true if converged otherwise false
+      */
+    bool gmres(const std::vector<double> & b, std::vector<double> & x);
+  public:
+    /**
+      * @brief Prepares matrix and preconditioner.
+      * @throw MatrixException
+      * @param matrix square matrix
+      * @param method iterative method
+      * @param type preconditioner
+      * @param tolerance required residual relative to the right-hand side
+      * @param maxIterations maximum number of iterations
+      */
+    IterativeSolver(const MatrixType & matrix, krylovMethods method, preconditioners type,
+                    double tolerance, size_t maxIterations);
+    /**
+      * @brief Solves Ax = b.
+      * @param b right-hand side
+      * @param[in, out] x initial guess and solution
+      * @return true if required tolerance was reached otherwise false
+      */
+    bool solve(const std::vector<double> & b, std::vector<double> & x);
+    /**
+      * @brief Returns number of iterations done by the last solve.
+      * @return iterations
+      */
+    size_t getIterations() const;
+    /**
+      * @brief Returns residual relative to the right-hand side reached by the last solve.
+      * @return relative residual
+      */
+    double getResidual() const;
+};
+
+#endif /* ITERATIVESOLVER_HPP */
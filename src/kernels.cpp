@@ -0,0 +1,195 @@
+#include "kernels.hpp"
+#include <algorithm>
+#include <vector>
+
+using namespace std;
+
+const size_t Kernels::TILE = 64;
+const size_t Kernels::STRASSEN_CROSSOVER = 128;
+const size_t Kernels::TRANSPOSE_BLOCK = 16;
+
+template<typename T>
+void Kernels::gemm(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                   const T * b, size_t ldb, T * c, size_t ldc){
+  for(size_t kk = 0; kk < k; kk += TILE){
+    size_t kEnd = min(k, kk + TILE);
+    for(size_t jj = 0; jj < n; jj += TILE){
+      size_t jEnd = min(n, jj + TILE);
+      for(size_t i = 0; i < m; ++i){
+        T * ci = c + i * ldc;
+        for(size_t p = kk; p < kEnd; ++p){
+          T aip = alpha * a[i * lda + p];
+          if(aip == 0)
+            continue;
+          const T * bp = b + p * ldb;
+          for(size_t j = jj; j < jEnd; ++j)
+            ci[j] += aip * bp[j];
+        }
+      }
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::combine(size_t m, size_t n, const T * a, size_t lda, T beta, const T * b, size_t ldb,
+                      T * c, size_t ldc){
+  for(size_t i = 0; i < m; ++i)
+    for(size_t j = 0; j < n; ++j)
+      c[i * ldc + j] = a[i * lda + j] + beta * b[i * ldb + j];
+}
+//---------------------------------------------------------------------------------------
+size_t Kernels::strassenWorkspace(size_t m, size_t n, size_t k, size_t crossover){
+  if(min(m, min(n, k)) <= max(crossover, (size_t) 1))
+    return 0;
+  size_t m2 = m / 2, n2 = n / 2, k2 = k / 2;
+  return m2 * max(k2, n2) + k2 * n2 + strassenWorkspace(m2, n2, k2, crossover);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::strassen(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                       T * c, size_t ldc, size_t crossover){
+  vector<T> work(strassenWorkspace(m, n, k, crossover));
+  strassenStep(m, n, k, a, lda, b, ldb, c, ldc, crossover, work.data());
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::strassenStep(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                           T * c, size_t ldc, size_t crossover, T * work){
+  if(min(m, min(n, k)) <= max(crossover, (size_t) 1)){
+    for(size_t i = 0; i < m; ++i)
+      fill(c + i * ldc, c + i * ldc + n, 0);
+    gemm<T>(m, n, k, 1, a, lda, b, ldb, c, ldc);
+    return;
+  }
+  size_t m2 = m / 2, n2 = n / 2, k2 = k / 2, ldx = max(k2, n2);
+  const T * a11 = a, * a12 = a + k2, * a21 = a + m2 * lda, * a22 = a21 + k2;
+  const T * b11 = b, * b12 = b + n2, * b21 = b + k2 * ldb, * b22 = b21 + n2;
+  T * c11 = c, * c12 = c + n2, * c21 = c + m2 * ldc, * c22 = c21 + n2;
+  T * x = work, * y = work + m2 * ldx, * rest = y + k2 * n2;
+
+  //Winograd's variant with two temporaries X and Y, products are stored in blocks of C
+  combine<T>(m2, k2, a11, lda, -1, a21, lda, x, ldx);                      //X = S3
+  combine<T>(k2, n2, b22, ldb, -1, b12, ldb, y, n2);                       //Y = T3
+  strassenStep(m2, n2, k2, x, ldx, y, n2, c21, ldc, crossover, rest);      //C21 = P7
+  combine<T>(m2, k2, a21, lda, 1, a22, lda, x, ldx);                       //X = S1
+  combine<T>(k2, n2, b12, ldb, -1, b11, ldb, y, n2);                       //Y = T1
+  strassenStep(m2, n2, k2, x, ldx, y, n2, c22, ldc, crossover, rest);      //C22 = P5
+  combine<T>(m2, k2, x, ldx, -1, a11, lda, x, ldx);                        //X = S2
+  combine<T>(k2, n2, b22, ldb, -1, y, n2, y, n2);                          //Y = T2
+  strassenStep(m2, n2, k2, x, ldx, y, n2, c12, ldc, crossover, rest);      //C12 = P6
+  combine<T>(m2, k2, a12, lda, -1, x, ldx, x, ldx);                        //X = S4
+  strassenStep(m2, n2, k2, x, ldx, b22, ldb, c11, ldc, crossover, rest);   //C11 = P3
+  strassenStep(m2, n2, k2, a11, lda, b11, ldb, x, ldx, crossover, rest);   //X = P1
+  combine<T>(m2, n2, x, ldx, 1, c12, ldc, c12, ldc);                       //C12 = U2
+  combine<T>(m2, n2, c12, ldc, 1, c21, ldc, c21, ldc);                     //C21 = U3
+  combine<T>(m2, n2, c12, ldc, 1, c22, ldc, c12, ldc);                     //C12 = U4
+  combine<T>(m2, n2, c21, ldc, 1, c22, ldc, c22, ldc);                     //C22 = U7
+  combine<T>(m2, n2, c12, ldc, 1, c11, ldc, c12, ldc);                     //C12 = U5
+  combine<T>(k2, n2, y, n2, -1, b21, ldb, y, n2);                          //Y = T4
+  strassenStep(m2, n2, k2, a22, lda, y, n2, c11, ldc, crossover, rest);    //C11 = P4
+  combine<T>(m2, n2, c21, ldc, -1, c11, ldc, c21, ldc);                    //C21 = U6
+  strassenStep(m2, n2, k2, a12, lda, b21, ldb, c11, ldc, crossover, rest); //C11 = P2
+  combine<T>(m2, n2, x, ldx, 1, c11, ldc, c11, ldc);                       //C11 = U1
+
+  //peeling of odd dimensions
+  if(k % 2)
+    gemm<T>(2 * m2, 2 * n2, 1, 1, a + k - 1, lda, b + (k - 1) * ldb, ldb, c, ldc);
+  if(n % 2){
+    for(size_t i = 0; i < 2 * m2; ++i)
+      c[i * ldc + n - 1] = 0;
+    gemm<T>(2 * m2, 1, k, 1, a, lda, b + n - 1, ldb, c + n - 1, ldc);
+  }
+  if(m % 2){
+    fill(c + (m - 1) * ldc, c + (m - 1) * ldc + n, 0);
+    gemm<T>(1, n, k, 1, a + (m - 1) * lda, lda, b, ldb, c + (m - 1) * ldc, ldc);
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::gemmNT(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                     const T * b, size_t ldb, T * c, size_t ldc){
+  for(size_t kk = 0; kk < k; kk += TILE){
+    size_t kEnd = min(k, kk + TILE);
+    for(size_t ii = 0; ii < m; ii += TILE){
+      size_t iEnd = min(m, ii + TILE);
+      for(size_t jj = 0; jj < n; jj += TILE){
+        size_t jEnd = min(n, jj + TILE);
+        for(size_t i = ii; i < iEnd; ++i){
+          const T * ai = a + i * lda;
+          for(size_t j = jj; j < jEnd; ++j){
+            const T * bj = b + j * ldb;
+            T val = 0;
+            for(size_t p = kk; p < kEnd; ++p)
+              val += ai[p] * bj[p];
+            c[i * ldc + j] += alpha * val;
+          }
+        }
+      }
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::gemmTN(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                     const T * b, size_t ldb, T * c, size_t ldc){
+  for(size_t kk = 0; kk < k; kk += TILE){
+    size_t kEnd = min(k, kk + TILE);
+    for(size_t ii = 0; ii < m; ii += TILE){
+      size_t iEnd = min(m, ii + TILE);
+      for(size_t jj = 0; jj < n; jj += TILE){
+        size_t jEnd = min(n, jj + TILE);
+        for(size_t p = kk; p < kEnd; ++p){
+          const T * ap = a + p * lda, * bp = b + p * ldb;
+          for(size_t i = ii; i < iEnd; ++i){
+            T api = alpha * ap[i];
+            if(api == 0)
+              continue;
+            T * ci = c + i * ldc;
+            for(size_t j = jj; j < jEnd; ++j)
+              ci[j] += api * bp[j];
+          }
+        }
+      }
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Kernels::transpose(size_t m, size_t n, const T * a, size_t lda, T * b, size_t ldb){
+  if(m <= TRANSPOSE_BLOCK && n <= TRANSPOSE_BLOCK){
+    for(size_t i = 0; i < m; ++i)
+      for(size_t j = 0; j < n; ++j)
+        b[j * ldb + i] = a[i * lda + j];
+    return;
+  }
+  //rows of A are columns of B
+  if(m >= n){
+    size_t m2 = m / 2;
+    transpose(m2, n, a, lda, b, ldb);
+    transpose(m - m2, n, a + m2 * lda, lda, b + m2, ldb);
+  }
+  else{
+    size_t n2 = n / 2;
+    transpose(m, n2, a, lda, b, ldb);
+    transpose(m, n - n2, a + n2, lda, b + n2 * ldb, ldb);
+  }
+}
+//---------------------------------------------------------------------------------------
+template void Kernels::gemm<double>(size_t, size_t, size_t, double, const double *, size_t,
+                                    const double *, size_t, double *, size_t);
+template void Kernels::gemm<float>(size_t, size_t, size_t, float, const float *, size_t,
+                                   const float *, size_t, float *, size_t);
+template void Kernels::strassen<double>(size_t, size_t, size_t, const double *, size_t, const double *, size_t,
+                                        double *, size_t, size_t);
+template void Kernels::strassen<float>(size_t, size_t, size_t, const float *, size_t, const float *, size_t,
+                                       float *, size_t, size_t);
+template void Kernels::gemmNT<double>(size_t, size_t, size_t, double, const double *, size_t,
+                                      const double *, size_t, double *, size_t);
+template void Kernels::gemmNT<float>(size_t, size_t, size_t, float, const float *, size_t,
+                                     const float *, size_t, float *, size_t);
+template void Kernels::gemmTN<double>(size_t, size_t, size_t, double, const double *, size_t,
+                                      const double *, size_t, double *, size_t);
+template void Kernels::gemmTN<float>(size_t, size_t, size_t, float, const float *, size_t,
+                                     const float *, size_t, float *, size_t);
+template void Kernels::transpose<double>(size_t, size_t, const double *, size_t, double *, size_t);
+template void Kernels::transpose<float>(size_t, size_t, const float *, size_t, float *, size_t);
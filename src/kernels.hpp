@@ -0,0 +1,166 @@
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstddef>
+
+/**
+  * @brief Low-level kernels working on dense row-major arrays.
+  *
+  * Every array is described by a pointer to its first element and by its leading
+  * dimension (distance between two consecutive rows), so kernels can work on any
+  * rectangular block of a bigger array. Kernels are instantiated for <b>double</b> and
+  * <b>float</b>.
+  */
+class Kernels{
+  private:
+    /**
+      * @brief Computes C = A + beta * B elementwise.
+      * C can be the same block as A or B.
+      * @param m rows
+      * @param n columns
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param beta multiplier of B
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[out] c matrix C
+      * @param ldc leading dimension of C
+      */
+    template<typename T>
+    static void combine(size_t m, size_t n, const T * a, size_t lda, T beta, const T * b, size_t ldb,
+                        T * c, size_t ldc);
+    /**
+      * @brief Returns size of workspace needed by strassenStep.
+      * @param m rows of A and C
+      * @param n columns of B and C
+      * @param k columns of A and rows of B
+      * @param crossover size below which gemm is used
+      * @return number of elements
+      */
+    static size_t strassenWorkspace(size_t m, size_t n, size_t k, size_t crossover);
+    /**
+      * @brief One level of Strassen-Winograd multiplication C = A * B.
+      * @param m rows of A and C
+      * @param n columns of B and C
+      * @param k columns of A and rows of B
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[out] c matrix C
+      * @param ldc leading dimension of C
+      * @param crossover size below which gemm is used
+      * @param work workspace of strassenWorkspace elements
+      */
+    template<typename T>
+    static void strassenStep(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                             T * c, size_t ldc, size_t crossover, T * work);
+  public:
+    /**
+      * @brief Size of the square tile used by blocked kernels.
+      */
+    static const size_t TILE;
+    /**
+      * @brief Default size below which strassen switches to gemm.
+      */
+    static const size_t STRASSEN_CROSSOVER;
+    /**
+      * @brief Size of blocks which are transposed directly.
+      */
+    static const size_t TRANSPOSE_BLOCK;
+
+    /**
+      * @brief General matrix multiplication C += alpha * A * B.
+      * A has dimensions m x k, B has dimensions k x n and C has dimensions m x n.
+      * Computation is split into tiles which fit into cache.
+      * @param m rows of A and C
+      * @param n columns of B and C
+      * @param k columns of A and rows of B
+      * @param alpha multiplier
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[in, out] c matrix C
+      * @param ldc leading dimension of C
+      */
+    template<typename T>
+    static void gemm(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                     const T * b, size_t ldb, T * c, size_t ldc);
+    /**
+      * @brief Matrix multiplication C = A * B by Strassen-Winograd algorithm.
+      * A has dimensions m x k, B has dimensions k x n and C has dimensions m x n.
+      * Every level splits matrices into 2 x 2 blocks and needs 7 block products instead
+      * of 8. Odd row or column is peeled off and added by gemm, so any dimensions are
+      * possible. Recursion stops when some dimension is at most <i>crossover</i>, then
+      * gemm is used. Workspace for all levels is allocated once.
+      * Result differs from gemm by rounding, error grows slightly with every level.
+      * @param m rows of A and C
+      * @param n columns of B and C
+      * @param k columns of A and rows of B
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[out] c matrix C
+      * @param ldc leading dimension of C
+      * @param crossover size below which gemm is used
+      */
+    template<typename T>
+    static void strassen(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                         T * c, size_t ldc, size_t crossover = STRASSEN_CROSSOVER);
+    /**
+      * @brief Matrix multiplication C += alpha * A * B<sup>T</sup>.
+      * A has dimensions m x k, B has dimensions n x k and C has dimensions m x n.
+      * Every element of C is a dot product of two rows, so B is read by rows and it is
+      * never transposed. Tiles of rows of A and B are kept in cache.
+      * @param m rows of A and C
+      * @param n rows of B and columns of C
+      * @param k columns of A and B
+      * @param alpha multiplier
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[in, out] c matrix C
+      * @param ldc leading dimension of C
+      */
+    template<typename T>
+    static void gemmNT(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                       const T * b, size_t ldb, T * c, size_t ldc);
+    /**
+      * @brief Matrix multiplication C += alpha * A<sup>T</sup> * B.
+      * A has dimensions k x m, B has dimensions k x n and C has dimensions m x n.
+      * Product is a sum of outer products of rows of A and B, so both matrices are read
+      * by rows and A is never transposed.
+      * @param m columns of A and rows of C
+      * @param n columns of B and C
+      * @param k rows of A and B
+      * @param alpha multiplier
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param b matrix B
+      * @param ldb leading dimension of B
+      * @param[in, out] c matrix C
+      * @param ldc leading dimension of C
+      */
+    template<typename T>
+    static void gemmTN(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                       const T * b, size_t ldb, T * c, size_t ldc);
+    /**
+      * @brief Transposes matrix B = A<sup>T</sup>.
+      * A has dimensions m x n and B has dimensions n x m. Cache-oblivious algorithm
+      * halves the longer dimension until blocks are small, so both arrays are accessed
+      * in blocks which fit into every level of cache without knowing its size.
+      * @param m rows of A
+      * @param n columns of A
+      * @param a matrix A
+      * @param lda leading dimension of A
+      * @param[out] b matrix B
+      * @param ldb leading dimension of B
+      */
+    template<typename T>
+    static void transpose(size_t m, size_t n, const T * a, size_t lda, T * b, size_t ldb);
+};
+
+#endif /* KERNELS_HPP */
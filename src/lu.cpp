@@ -0,0 +1,139 @@
+#include "lu.hpp"
+#include "kernels.hpp"
+#include "processPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+using namespace std;
+
+template<typename T>
+const size_t BasicLU<T>::DEFAULT_BLOCK_SIZE = 64;
+
+template<typename T>
+BasicLU<T>::BasicLU(const MatrixType & matrix, size_t blockSize) : r(matrix.getRows()), c(matrix.getCols()),
+  n(min(r, c)), blockSize(max(blockSize, (size_t) 1)), data(r * c), perm(r){
+  T largest = 0;
+  for(size_t i = 0; i < r; ++i){
+    perm[i] = i;
+    for(size_t j = 0; j < c; ++j){
+      at(i, j) = matrix.getValue(i, j);
+      largest = max(largest, (T) fabs(at(i, j)));
+    }
+  }
+  tolerance = largest * max(r, c) * numeric_limits<T>::epsilon();
+  factor();
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+T & BasicLU<T>::at(size_t i, size_t j){
+  return data[i * c + j];
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+T BasicLU<T>::at(size_t i, size_t j) const{
+  return data[i * c + j];
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void BasicLU<T>::factor(){
+  for(size_t col = 0; col < n; col += blockSize){
+    size_t width = min(blockSize, n - col), end = col + width;
+    factorPanel(col, width);
+    //rows of the panel to the right of it: U12 = inverse(L11) * A12
+    for(size_t j = col; j < end; ++j)
+      for(size_t i = j + 1; i < end; ++i){
+        T l = at(i, j);
+        if(l == 0)
+          continue;
+        for(size_t k = end; k < c; ++k)
+          at(i, k) -= l * at(j, k);
+      }
+    //trailing submatrix: A22 -= L21 * U12
+    if(end < r && end < c)
+      ProcessPool::getInstance().gemm<T>(r - end, c - end, width, -1, &data[end * c + col], c,
+                                         &data[col * c + end], c, &data[end * c + end], c);
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void BasicLU<T>::factorPanel(size_t col, size_t width){
+  size_t end = col + width;
+  for(size_t j = col; j < end; ++j){
+    //find the largest element in the column
+    size_t p = j;
+    for(size_t i = j + 1; i < r; ++i)
+      if(fabs(at(i, j)) > fabs(at(p, j)))
+        p = i;
+    if(fabs(at(p, j)) <= tolerance){
+      //nothing to eliminate, forget rounding residue
+      for(size_t i = j; i < r; ++i)
+        at(i, j) = 0;
+      singular = true;
+      det = 0;
+      continue;
+    }
+    if(p != j){
+      swap_ranges(data.begin() + p * c, data.begin() + (p + 1) * c, data.begin() + j * c);
+      swap(perm[p], perm[j]);
+      det *= -1;
+    }
+    T pivot = at(j, j);
+    det *= pivot;
+    for(size_t i = j + 1; i < r; ++i){
+      T l = (at(i, j) /= pivot);
+      if(l == 0)
+        continue;
+      for(size_t k = j + 1; k < end; ++k)
+        at(i, k) -= l * at(j, k);
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+bool BasicLU<T>::isSingular() const{
+  return singular;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+double BasicLU<T>::getDeterminant() const{
+  return det;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void BasicLU<T>::solve(vector<double> & b, size_t cols) const{
+  vector<T> x(b.size());
+  for(size_t i = 0; i < n; ++i)
+    copy(b.begin() + perm[i] * cols, b.begin() + (perm[i] + 1) * cols, x.begin() + i * cols);
+  //forward substitution with unit lower triangular L
+  for(size_t i = 0; i < n; ++i){
+    T * xi = &x[i * cols];
+    for(size_t k = 0; k < i; ++k){
+      T l = at(i, k);
+      if(l == 0)
+        continue;
+      const T * xk = &x[k * cols];
+      for(size_t j = 0; j < cols; ++j)
+        xi[j] -= l * xk[j];
+    }
+  }
+  //back substitution with upper triangular U
+  for(size_t i = n; i-- > 0;){
+    T * xi = &x[i * cols];
+    for(size_t k = i + 1; k < n; ++k){
+      T u = at(i, k);
+      if(u == 0)
+        continue;
+      const T * xk = &x[k * cols];
+      for(size_t j = 0; j < cols; ++j)
+        xi[j] -= u * xk[j];
+    }
+    T pivot = at(i, i);
+    for(size_t j = 0; j < cols; ++j)
+      xi[j] /= pivot;
+  }
+  copy(x.begin(), x.end(), b.begin());
+}
+//---------------------------------------------------------------------------------------
+template class BasicLU<double>;
+template class BasicLU<float>;
@@ -0,0 +1,77 @@
+#ifndef LU_HPP
+#define LU_HPP
+
+#include <vector>
+#include "factorization.hpp"
+#include "matrixType.hpp"
+
+/**
+  * @brief Blocked LU factorization with partial pivoting.
+  *
+  * Matrix is factored as PA = LU where P is permutation, L is unit lower triangular
+  * and U is upper triangular. Columns are processed in panels of <i>blockSize</i>
+  * columns. Each panel is factored element-wise and then the whole trailing submatrix is
+  * updated by a single matrix multiplication, so most of the work is done by cache
+  * friendly Kernels::gemm. Factors are stored in type T, which is instantiated for
+  * <b>double</b> (LU) and for <b>float</b> (FloatLU).
+  */
+template<typename T>
+class BasicLU : public Factorization{
+  private:
+    size_t r, ///< Number of rows.
+           c, ///< Number of columns.
+           n, ///< Number of eliminated columns (minimum of r and c).
+           blockSize; ///< Number of columns in one panel.
+    std::vector<T> data; ///< Factors L and U stored row by row in one array.
+    std::vector<size_t> perm; ///< <i>i</i>-th row of PA is <i>perm[i]</i>-th row of A.
+    double det = 1; ///< Determinant.
+    T tolerance = 0; ///< Pivots with smaller absolute value are treated as zero.
+    bool singular = false; ///< Whether a zero pivot was found.
+
+    /**
+      * @brief Returns reference to the element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    T & at(size_t i, size_t j);
+    /**
+      * @brief Returns the element in <i>i</i>-th row and <i>j</i>-th column.
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    T at(size_t i, size_t j) const;
+    /**
+      * @brief Factors panel of columns.
+      * Panel starts in <i>col</i>-th column and has <i>width</i> columns. Rows of the
+      * whole matrix are swapped, but only columns of the panel are eliminated.
+      * @param col first column of the panel
+      * @param width number of columns of the panel
+      */
+    void factorPanel(size_t col, size_t width);
+    /**
+      * @brief Performs the whole factorization.
+      */
+    void factor();
+  public:
+    /**
+      * @brief Default number of columns in one panel.
+      */
+    static const size_t DEFAULT_BLOCK_SIZE;
+
+    /**
+      * @brief Factors matrix.
+      * @param matrix matrix
+      * @param blockSize number of columns in one panel
+      */
+    BasicLU(const MatrixType & matrix, size_t blockSize = DEFAULT_BLOCK_SIZE);
+    virtual bool isSingular() const;
+    virtual double getDeterminant() const;
+    virtual void solve(std::vector<double> & b, size_t cols) const;
+};
+
+typedef BasicLU<double> LU; ///< LU factorization in double precision.
+typedef BasicLU<float> FloatLU; ///< LU factorization in single precision.
+
+#endif /* LU_HPP */
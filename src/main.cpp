@@ -1,14 +1,31 @@
 #include <iostream>
 #include <string>
+#include <cstring>
 #include <exception>
 #include "matrix.hpp"
 #include "handler.hpp"
+#include "server.hpp"
+#include "processPool.hpp"
 
 using namespace std;
 
-int main(){
+int main(int argc, char * argv[]){
+  //worker of SET workers never returns from here
+  ProcessPool::runWorker(argc, argv);
+  ios::sync_with_stdio(false);
   string input;
   Handler h;
+  if(argc > 1){
+    //batch mode: hruskraj -f script [-v]
+    if(strcmp(argv[1], "-f") == 0 && argc >= 3 && argc <= 4
+       && (argc == 3 || strcmp(argv[3], "-v") == 0))
+      return h.run(argv[2], argc == 4) ? 0 : 1;
+    //server mode: hruskraj -s socket
+    if(strcmp(argv[1], "-s") == 0 && argc == 3)
+      return Server(argv[2]).run() ? 0 : 1;
+    cerr << "Usage: " << argv[0] << " [-f script [-v] | -s socket]" << endl;
+    return 2;
+  }
   while(getline(cin, input)){
     try{
       if(!h.execute(input))
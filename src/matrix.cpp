@@ -1,163 +1,1046 @@
 #include "matrix.hpp"
+#include "processPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 using namespace std;
 
 const char * Matrix::DIMENSION = "Wrong dimensions!";
 const char * Matrix::SINGULAR = "Singular matrix!"; 
+const char * Matrix::FIELD = "Matrices are over different fields!";
 const double Matrix::DENSITY_TRESHOLD = 0.6;
+const size_t Matrix::FIXED_SIZE = 8;
+const size_t Matrix::FIXED_BATCH_SIZE = 4;
+const size_t Matrix::BAND_RATIO = 4;
+atomic<size_t> Matrix::blockSize(LU::DEFAULT_BLOCK_SIZE);
+atomic<bool> Matrix::exact(true);
+atomic<bool> Matrix::strassen(true);
 
+Transposed::Transposed(const Matrix & m) : m(m){
+}
+//---------------------------------------------------------------------------------------
+const Matrix & Transposed::getMatrix() const{
+  return m;
+}
+//---------------------------------------------------------------------------------------
 void Matrix::copyMatrix(MatrixType * const & src, MatrixType * & out) const{
+  MatrixType * dst = out;
+  src->forEachNonZero([dst](size_t i, size_t j, double x){
+    dst->setValue(i, j, x);
+  });
+}
+//---------------------------------------------------------------------------------------
+MatrixType * Matrix::newStorage(bool dense) const{
+  if(isBinary)
+    return new BitMatrix(r, c);
+  if(!dense)
+    return new SparseMatrix(r, c);
+  if(isSingle)
+    return new FloatMatrix(r, c);
+  return new DenseMatrix(r, c);
+}
+//---------------------------------------------------------------------------------------
+MatrixType * Matrix::newStorage(size_t r, size_t c, double zeros, bool single){
+  if(zeros >= DENSITY_TRESHOLD)
+    return new SparseMatrix(r, c);
+  if(single)
+    return new FloatMatrix(r, c);
+  return new DenseMatrix(r, c);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::fromArray(size_t r, size_t c, const vector<double> & data, bool single){
+  size_t zeros = count(data.begin(), data.end(), 0.0);
+  MatrixType * tmp = newStorage(r, c, zeros / (double) (r * c), single);
   for(size_t i = 0; i < r; ++i)
     for(size_t j = 0; j < c; ++j)
-      out->setValue(i, j, src->getValue(i, j));
+      if(data[i * c + j] != 0)
+        tmp->setValue(i, j, data[i * c + j]);
+  return Matrix(r, c, tmp, single);
+}
+//---------------------------------------------------------------------------------------
+double Matrix::expectedZeros() const{
+  return isDense && isGeneral() ? 0 : matrix->getRatioOfZeros();
+}
+//---------------------------------------------------------------------------------------
+Matrix::Matrix(size_t r, size_t c, MatrixType * data)
+  : Matrix(r, c, data, dynamic_cast<FloatMatrix *>(data) != NULL){
 }
 //---------------------------------------------------------------------------------------
-Matrix::Matrix(size_t r, size_t c, MatrixType * data) : r(r), c(c), matrix(data){
+Matrix::Matrix(size_t r, size_t c, MatrixType * data, bool single, bool detect)
+  : r(r), c(c), isSingle(single), matrix(data){
   if(r == 0 || c == 0)
     throw MatrixException(DIMENSION);
   if(matrix == NULL){
-    matrix = new SparseMatrix(r, c);
+    matrix.reset(new SparseMatrix(r, c));
+    return;
+  }
+  if(dynamic_cast<BitMatrix *>(matrix.get())){
+    isBinary = true;
+    isSingle = false;
     return;
   }
+  const StructuredMatrix * structured = dynamic_cast<StructuredMatrix *>(matrix.get());
+  if(structured){
+    structure = structured->getStructure();
+    return;
+  }
+  isDense = dynamic_cast<SparseMatrix *>(matrix.get()) == NULL;
+  if(isDense && isSingle != (dynamic_cast<FloatMatrix *>(matrix.get()) != NULL)){
+    MatrixType * tmp = newStorage(true);
+    copyMatrix(matrix.get(), tmp);
+    matrix.reset(tmp);
+  }
   checkCountOfZeros();
+  if(detect)
+    checkStructure();
 }
 //---------------------------------------------------------------------------------------
-Matrix::Matrix(const Matrix & other) : r(other.r), c(other.c), isDense(other.isDense){
-  if(isDense)
-    matrix = new DenseMatrix(r, c);
-  else
-    matrix = new SparseMatrix(r, c);
-  copyMatrix(other.matrix, matrix);
-  checkCountOfZeros();
+Matrix::Matrix(size_t r, size_t c, const shared_ptr<MatrixType> & view, bool single)
+  : r(r), c(c), isSingle(single), isView(true), matrix(view){
+  if(r == 0 || c == 0)
+    throw MatrixException(DIMENSION);
+}
+//---------------------------------------------------------------------------------------
+Matrix::Matrix(const Matrix & other) : r(other.r), c(other.c), isDense(other.isDense),
+  isSingle(other.isSingle), isView(other.isView), isBinary(other.isBinary), structure(other.structure), matrix(other.matrix),
+  factorization(atomic_load(&other.factorization)){
 }
 //---------------------------------------------------------------------------------------
 Matrix & Matrix::operator =(const Matrix & other){
   if(this == &other)
     return *this;
-  delete matrix;
   r = other.r;
   c = other.c;
   isDense = other.isDense;
-  if(isDense)
-    matrix = new DenseMatrix(r, c);
-  else
-    matrix = new SparseMatrix(r, c);
-  copyMatrix(other.matrix, matrix);
-  checkCountOfZeros();
+  isSingle = other.isSingle;
+  isView = other.isView;
+  isBinary = other.isBinary;
+  structure = other.structure;
+  factorization = atomic_load(&other.factorization);
+  matrix = other.matrix;
   return *this;
 }
 //---------------------------------------------------------------------------------------
 Matrix::~Matrix(){
-  delete matrix;
+}
+//---------------------------------------------------------------------------------------
+void Matrix::setBlockSize(size_t size){
+  if(size == 0)
+    throw MatrixException("Block size must be positive!");
+  blockSize = size;
+}
+//---------------------------------------------------------------------------------------
+void Matrix::setExact(bool on){
+  exact = on;
+}
+//---------------------------------------------------------------------------------------
+void Matrix::setStrassen(bool on){
+  strassen = on;
+}
+//---------------------------------------------------------------------------------------
+size_t Matrix::getRows() const{
+  return r;
+}
+//---------------------------------------------------------------------------------------
+size_t Matrix::getCols() const{
+  return c;
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::isSinglePrecision() const{
+  return isSingle;
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::toSingle() const{
+  if(isBinary)
+    return toDouble().toSingle();
+  if(!isGeneral())
+    return materialize().toSingle();
+  MatrixType * tmp = isDense ? new FloatMatrix(r, c) : newStorage(false);
+  copyMatrix(matrix.get(), tmp);
+  return Matrix(r, c, tmp, true);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::toDouble() const{
+  if(isBinary){
+    MatrixType * tmp = newStorage(r, c, matrix->getRatioOfZeros(), false);
+    copyMatrix(matrix.get(), tmp);
+    return Matrix(r, c, tmp, false);
+  }
+  if(!isGeneral())
+    return materialize().toDouble();
+  MatrixType * tmp = isDense ? new DenseMatrix(r, c) : newStorage(false);
+  copyMatrix(matrix.get(), tmp);
+  return Matrix(r, c, tmp, false);
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::isBinaryField() const{
+  return isBinary;
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::toBinary() const{
+  if(isBinary)
+    return *this;
+  return Matrix(r, c, new BitMatrix(*matrix), false);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::adoptDense(size_t r, size_t c, T * data){
+  //view constructor skips checks of zeros and structure which would copy the array
+  Matrix out(r, c, make_shared<BasicDenseMatrix<T>>(r, c, data), sizeof(T) == sizeof(float));
+  out.isView = false;
+  out.isDense = true;
+  return out;
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::adopt(size_t r, size_t c, double * data){
+  return adoptDense(r, c, data);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::adopt(size_t r, size_t c, float * data){
+  return adoptDense(r, c, data);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::adopt(size_t r, size_t c, const size_t * rowPtr, const size_t * cols, const double * values){
+  if(r == 0 || c == 0)
+    throw MatrixException(DIMENSION);
+  return Matrix(r, c, make_shared<CompressedRows>(r, c, rowPtr, cols, values), false);
+}
+//---------------------------------------------------------------------------------------
+size_t Matrix::countNonZeros() const{
+  size_t count = 0;
+  matrix->forEachNonZero([&](size_t, size_t, double){
+    ++count;
+  });
+  return count;
+}
+//---------------------------------------------------------------------------------------
+size_t Matrix::getMemory() const{
+  return matrix->getMemory();
+}
+//---------------------------------------------------------------------------------------
+const char * Matrix::getStorageName() const{
+  if(isBinary)
+    return "gf2";
+  if(isView)
+    return "view";
+  switch(structure){
+    case structures::DIAGONAL:
+      return "diagonal";
+    case structures::UPPER:
+      return "upper";
+    case structures::LOWER:
+      return "lower";
+    case structures::SYMMETRIC:
+      return "symmetric";
+    case structures::BANDED:
+      return "band";
+    default:
+      break;
+  }
+  if(!isDense)
+    return "sparse";
+  return isSingle ? "float" : "dense";
+}
+//---------------------------------------------------------------------------------------
+void Matrix::copyTo(double * out) const{
+  if(isDense && isGeneral() && !isSingle){
+    const double * data = static_cast<const DenseMatrix *>(matrix.get())->getData();
+    copy(data, data + r * c, out);
+    return;
+  }
+  fill(out, out + r * c, 0.0);
+  matrix->forEachNonZero([&](size_t i, size_t j, double x){
+    out[i * c + j] = x;
+  });
+}
+//---------------------------------------------------------------------------------------
+void Matrix::copyTo(size_t * rowPtr, size_t * cols, double * values) const{
+  size_t count = 0;
+  for(size_t i = 0; i < r; ++i){
+    rowPtr[i] = count;
+    matrix->forEachNonZeroInRow(i, [&](size_t j, double x){
+      cols[count] = j;
+      values[count++] = x;
+    });
+  }
+  rowPtr[r] = count;
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::binaryWith(const Matrix & other) const{
+  if(isBinary != other.isBinary)
+    throw MatrixException(FIELD);
+  return isBinary;
+}
+//---------------------------------------------------------------------------------------
+const BitMatrix & Matrix::bits() const{
+  return *static_cast<const BitMatrix *>(matrix.get());
 }
 //---------------------------------------------------------------------------------------
 void Matrix::checkCountOfZeros(){
+  if(isBinary)
+    return;
   double tmp = matrix->getRatioOfZeros();
   if((isDense && tmp >= DENSITY_TRESHOLD) || (!isDense && tmp <= DENSITY_TRESHOLD))
     useOtherTypeOfMatrix();
 }
 //---------------------------------------------------------------------------------------
 void Matrix::useOtherTypeOfMatrix(){
-  MatrixType * tmp;  
-  if(isDense)
-    tmp = new SparseMatrix(r, c);
-  else
-    tmp = new DenseMatrix(r, c);
-  copyMatrix(matrix, tmp);
-  delete matrix;
+  MatrixType * tmp = newStorage(!isDense);
+  copyMatrix(matrix.get(), tmp);
   isDense = !isDense;
-  matrix = tmp; 
+  matrix.reset(tmp);
+}
+//---------------------------------------------------------------------------------------
+void Matrix::checkStructure(){
+  if(isBinary)
+    return;
+  if(r != c || r <= FIXED_SIZE)
+    return;
+  structures s = StructuredMatrix::detect(*matrix);
+  size_t lower, upper;
+  StructuredMatrix * tmp;
+  if(s != structures::DIAGONAL && BandMatrix::findBand(*matrix, r / BAND_RATIO, lower, upper))
+    tmp = new BandMatrix(r, lower, upper);
+  //sparse storage is as good for sparse triangular and symmetric matrices
+  else if(s == structures::GENERAL || (!isDense && s != structures::DIAGONAL))
+    return;
+  else
+    tmp = StructuredMatrix::make(s, r);
+  tmp->copyFrom(*matrix);
+  matrix.reset(tmp);
+  isDense = false;
+  structure = tmp->getStructure();
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::isGeneral() const{
+  return !isView && structure == structures::GENERAL;
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::isBand() const{
+  return structure == structures::BANDED || structure == structures::DIAGONAL;
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::materialize() const{
+  if(isGeneral())
+    return *this;
+  //storage is chosen the same way as if elements were copied to a sparse matrix first
+  MatrixType * tmp = newStorage(matrix->getRatioOfZeros() < DENSITY_TRESHOLD);
+  if(isView)
+    copyMatrix(matrix.get(), tmp);
+  else
+    static_cast<const StructuredMatrix *>(matrix.get())->copyTo(*tmp);
+  return Matrix(r, c, tmp, isSingle, false);
+}
+//---------------------------------------------------------------------------------------
+void Matrix::detach(){
+  if(!isGeneral())
+    *this = materialize();
+  else if(matrix.use_count() > 1){
+    MatrixType * tmp = newStorage(isDense);
+    copyMatrix(matrix.get(), tmp);
+    matrix.reset(tmp);
+  }
+}
+//---------------------------------------------------------------------------------------
+bool Matrix::isAdopted() const{
+  if(!isDense || isView)
+    return false;
+  return isSingle ? !static_cast<const FloatMatrix *>(matrix.get())->isOwned()
+                  : !static_cast<const DenseMatrix *>(matrix.get())->isOwned();
+}
+//---------------------------------------------------------------------------------------
+Matrix & Matrix::assign(const Matrix & result){
+  if(!isAdopted() || matrix.use_count() > 1 || result.r != r || result.c != c)
+    return (*this = result);
+  if(isSingle){
+    vector<double> tmp(r * c);
+    result.copyTo(tmp.data());
+    copy(tmp.begin(), tmp.end(), static_cast<FloatMatrix *>(matrix.get())->getData());
+  }
+  else
+    result.copyTo(static_cast<DenseMatrix *>(matrix.get())->getData());
+  factorization.reset();
+  return *this;
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::operator +(const Matrix & other) const{
   if(r != other.r || c != other.c)
     throw MatrixException(DIMENSION);
-  MatrixType * tmp = new SparseMatrix(r, c);
-  for(size_t i = 0; i < r; ++i)
-    for(size_t j = 0; j < c; ++j)
-      tmp->setValue(i, j, matrix->getValue(i, j) + other.matrix->getValue(i, j));
-  return Matrix(r, c, tmp);
+  if(binaryWith(other))
+    return Matrix(r, c, bits().add(other.bits()), false);
+  if((structure == structures::BANDED || other.structure == structures::BANDED) && isBand() && other.isBand())
+    return addBands(other);
+  if(structure != structures::GENERAL && structure == other.structure){
+    //packed arrays of the same structure have the same layout
+    StructuredMatrix * tmp = static_cast<const StructuredMatrix *>(matrix.get())->makeZero();
+    const vector<double> & a = static_cast<const StructuredMatrix *>(matrix.get())->getData(),
+                         & b = static_cast<const StructuredMatrix *>(other.matrix.get())->getData();
+    for(size_t i = 0; i < a.size(); ++i)
+      tmp->getData()[i] = a[i] + b[i];
+    return Matrix(r, c, tmp, isSingle && other.isSingle);
+  }
+  //rows of both matrices are merged by columns, element of the sum is zero if both are zero
+  MatrixType * tmp = newStorage(r, c, expectedZeros() * other.expectedZeros(), isSingle && other.isSingle);
+  vector<pair<size_t, double>> a, b, sum;
+  for(size_t i = 0; i < r; ++i){
+    a.clear();
+    b.clear();
+    sum.clear();
+    matrix->forEachNonZeroInRow(i, [&a](size_t j, double x){ a.emplace_back(j, x); });
+    other.matrix->forEachNonZeroInRow(i, [&b](size_t j, double x){ b.emplace_back(j, x); });
+    size_t p = 0, q = 0;
+    while(p < a.size() || q < b.size()){
+      if(q == b.size() || (p < a.size() && a[p].first < b[q].first))
+        sum.push_back(a[p++]);
+      else if(p == a.size() || b[q].first < a[p].first)
+        sum.push_back(b[q++]);
+      else{
+        if(a[p].second + b[q].second != 0)
+          sum.emplace_back(a[p].first, a[p].second + b[q].second);
+        ++p;
+        ++q;
+      }
+    }
+    tmp->setRowValues(i, sum);
+  }
+  return Matrix(r, c, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::multiplyDense(const Matrix & other) const{
+  BasicDenseMatrix<T> * tmp = new BasicDenseMatrix<T>(r, other.c);
+  const T * a = static_cast<const BasicDenseMatrix<T> *>(matrix.get())->getData(),
+          * b = static_cast<const BasicDenseMatrix<T> *>(other.matrix.get())->getData();
+  if(strassen && min(r, min(c, other.c)) > Kernels::STRASSEN_CROSSOVER)
+    ProcessPool::getInstance().strassen<T>(r, other.c, c, a, c, b, other.c, tmp->getData(), other.c);
+  else
+    ProcessPool::getInstance().gemm<T>(r, other.c, c, 1, a, c, b, other.c, tmp->getData(), other.c);
+  return Matrix(r, other.c, tmp, isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::multiplyTransposed(const Matrix & other, bool left) const{
+  const T * a = static_cast<const BasicDenseMatrix<T> *>(matrix.get())->getData(),
+          * b = static_cast<const BasicDenseMatrix<T> *>(other.matrix.get())->getData();
+  if(left){
+    BasicDenseMatrix<T> * tmp = new BasicDenseMatrix<T>(c, other.c);
+    Kernels::gemmTN<T>(c, other.c, r, 1, a, c, b, other.c, tmp->getData(), other.c);
+    return Matrix(c, other.c, tmp, isSingle);
+  }
+  BasicDenseMatrix<T> * tmp = new BasicDenseMatrix<T>(r, other.r);
+  Kernels::gemmNT<T>(r, other.r, c, 1, a, c, b, other.c, tmp->getData(), other.r);
+  return Matrix(r, other.r, tmp, isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::transposeDense() const{
+  BasicDenseMatrix<T> * tmp = new BasicDenseMatrix<T>(c, r);
+  Kernels::transpose<T>(r, c, static_cast<const BasicDenseMatrix<T> *>(matrix.get())->getData(), c,
+                        tmp->getData(), r);
+  return Matrix(c, r, tmp, isSingle);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::multiplyDiagonal(const Matrix & other) const{
+  //rows of the other matrix are scaled by the diagonal of this matrix or vice versa
+  bool left = structure == structures::DIAGONAL;
+  const Matrix & m = left ? other : *this;
+  const vector<double> & d = static_cast<const StructuredMatrix *>((left ? matrix : other.matrix).get())->getData();
+  if(m.structure == structures::DIAGONAL){
+    DiagonalMatrix * tmp = new DiagonalMatrix(r);
+    const vector<double> & e = static_cast<const StructuredMatrix *>(m.matrix.get())->getData();
+    for(size_t i = 0; i < r; ++i)
+      tmp->getData()[i] = d[i] * e[i];
+    return Matrix(r, c, tmp, isSingle && other.isSingle);
+  }
+  MatrixType * tmp = m.isDense ? (MatrixType *) new DenseMatrix(r, other.c) : new SparseMatrix(r, other.c);
+  m.matrix->forEachNonZero([tmp, &d, left](size_t i, size_t j, double x){
+    tmp->setValue(i, j, x * d[left ? i : j]);
+  });
+  return Matrix(r, other.c, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::multiplySymmetric(const Matrix & other) const{
+  const StructuredMatrix * s = static_cast<const StructuredMatrix *>(matrix.get());
+  const vector<double> & a = s->getData();
+  const T * b = static_cast<const BasicDenseMatrix<T> *>(other.matrix.get())->getData();
+  DenseMatrix * tmp = new DenseMatrix(r, other.c);
+  double * out = tmp->getData();
+  size_t n = other.c;
+  //every stored element above the diagonal is used for row i and for row j
+  for(size_t i = 0; i < r; ++i){
+    const double * ai = &a[s->index(i, i)];
+    for(size_t j = i; j < c; ++j){
+      double x = ai[j - i];
+      if(x == 0)
+        continue;
+      for(size_t k = 0; k < n; ++k)
+        out[i * n + k] += x * b[j * n + k];
+      if(j != i)
+        for(size_t k = 0; k < n; ++k)
+          out[j * n + k] += x * b[i * n + k];
+    }
+  }
+  return Matrix(r, n, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::multiplyGram() const{
+  const T * a = static_cast<const BasicDenseMatrix<T> *>(matrix.get())->getData();
+  SymmetricMatrix * tmp = new SymmetricMatrix(r);
+  vector<double> & out = tmp->getData();
+  //only the upper triangle of the symmetric product is computed
+  for(size_t ii = 0; ii < r; ii += Kernels::TILE)
+    for(size_t jj = ii; jj < r; jj += Kernels::TILE)
+      for(size_t i = ii; i < min(r, ii + Kernels::TILE); ++i)
+        for(size_t j = max(i, jj); j < min(r, jj + Kernels::TILE); ++j){
+          T val = 0;
+          for(size_t k = 0; k < c; ++k)
+            val += a[i * c + k] * a[j * c + k];
+          out[tmp->index(i, j)] = val;
+        }
+  return Matrix(r, r, tmp, isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+Matrix Matrix::multiplyBanded(const Matrix & other) const{
+  bool left = structure == structures::BANDED;
+  const StructuredMatrix * s = static_cast<const StructuredMatrix *>((left ? matrix : other.matrix).get());
+  const vector<double> & a = s->getData();
+  const T * b = static_cast<const BasicDenseMatrix<T> *>((left ? other : *this).matrix.get())->getData();
+  DenseMatrix * tmp = new DenseMatrix(r, other.c);
+  double * out = tmp->getData();
+  size_t n = other.c;
+  if(left)
+    //i-th row of the product combines rows of the dense matrix in the band of i-th row
+    for(size_t i = 0; i < r; ++i){
+      size_t first, last;
+      s->rowRange(i, first, last);
+      for(size_t j = first; j < last; ++j){
+        double x = a[s->index(i, j)];
+        if(x == 0)
+          continue;
+        for(size_t k = 0; k < n; ++k)
+          out[i * n + k] += x * b[j * n + k];
+      }
+    }
+  else
+    //j-th element of every row of the dense matrix is used for the band of j-th row
+    for(size_t i = 0; i < r; ++i)
+      for(size_t j = 0; j < c; ++j){
+        T x = b[i * c + j];
+        if(x == 0)
+          continue;
+        size_t first, last;
+        s->rowRange(j, first, last);
+        const double * aj = &a[s->index(j, first)];
+        for(size_t k = first; k < last; ++k)
+          out[i * n + k] += x * aj[k - first];
+      }
+  return Matrix(r, n, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::multiplyBands(const Matrix & other) const{
+  const StructuredMatrix * a = static_cast<const StructuredMatrix *>(matrix.get()),
+                         * b = static_cast<const StructuredMatrix *>(other.matrix.get());
+  BandMatrix * tmp = new BandMatrix(r, min(r - 1, a->getLowerBandwidth() + b->getLowerBandwidth()),
+                                    min(r - 1, a->getUpperBandwidth() + b->getUpperBandwidth()));
+  vector<double> & out = tmp->getData();
+  for(size_t i = 0; i < r; ++i){
+    size_t first, last;
+    a->rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j){
+      double x = a->getData()[a->index(i, j)];
+      if(x == 0)
+        continue;
+      size_t firstB, lastB;
+      b->rowRange(j, firstB, lastB);
+      for(size_t k = firstB; k < lastB; ++k)
+        out[tmp->index(i, k)] += x * b->getData()[b->index(j, k)];
+    }
+  }
+  Matrix m(r, c, tmp, isSingle && other.isSingle);
+  if((tmp->getLowerBandwidth() + tmp->getUpperBandwidth() + 1) * BAND_RATIO > r)
+    return m.materialize();
+  return m;
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::addBands(const Matrix & other) const{
+  const StructuredMatrix * a = static_cast<const StructuredMatrix *>(matrix.get()),
+                         * b = static_cast<const StructuredMatrix *>(other.matrix.get());
+  BandMatrix * tmp = new BandMatrix(r, max(a->getLowerBandwidth(), b->getLowerBandwidth()),
+                                    max(a->getUpperBandwidth(), b->getUpperBandwidth()));
+  vector<double> & out = tmp->getData();
+  for(const StructuredMatrix * m : {a, b})
+    for(size_t i = 0; i < r; ++i){
+      size_t first, last;
+      m->rowRange(i, first, last);
+      for(size_t j = first; j < last; ++j)
+        out[tmp->index(i, j)] += m->getData()[m->index(i, j)];
+    }
+  return Matrix(r, c, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+template<size_t N>
+FixedMatrix<double, N, N> Matrix::toFixed() const{
+  FixedMatrix<double, N, N> out;
+  //dense storage of N x N matrix is stored row by row like FixedMatrix
+  if(isDense && !isView){
+    if(isSingle){
+      const float * from = static_cast<const FloatMatrix *>(matrix.get())->getData();
+      copy(from, from + N * N, out.getData());
+    }
+    else{
+      const double * from = static_cast<const DenseMatrix *>(matrix.get())->getData();
+      copy(from, from + N * N, out.getData());
+    }
+  }
+  else
+    matrix->forEachNonZero([&](size_t i, size_t j, double x){
+      out(i, j) = x;
+    });
+  return out;
+}
+//---------------------------------------------------------------------------------------
+template<size_t N>
+Matrix Matrix::fromFixed(const FixedMatrix<double, N, N> & m, bool single){
+  const double * from = m.getData();
+  shared_ptr<MatrixType> tmp;
+  if(single){
+    shared_ptr<FloatMatrix> dense = make_shared<FloatMatrix>(N, N);
+    copy(from, from + N * N, dense->getData());
+    tmp = dense;
+  }
+  else{
+    shared_ptr<DenseMatrix> dense = make_shared<DenseMatrix>(N, N);
+    copy(from, from + N * N, dense->getData());
+    tmp = dense;
+  }
+  //view constructor skips checks of zeros and structure, tiny result stays dense
+  Matrix out(N, N, tmp, single);
+  out.isView = false;
+  out.isDense = true;
+  return out;
+}
+//---------------------------------------------------------------------------------------
+template<size_t N>
+Matrix Matrix::fixed(char op, const Matrix & other, double & det) const{
+  FixedMatrix<double, N, N> a = toFixed<N>();
+  if(op == '*')
+    return fromFixed<N>(a * other.toFixed<N>(), isSingle && other.isSingle);
+  if(op == 'd'){
+    det = FixedSquare<double, N>::determinant(a);
+    if(isNegligible<N>(a, det))
+      det = 0;
+    return *this;
+  }
+  FixedMatrix<double, N, N> inv;
+  det = FixedSquare<double, N>::invert(a, inv);
+  if(isNegligible<N>(a, det))
+    throw MatrixException(SINGULAR);
+  return fromFixed<N>(inv, isSingle);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::fixedDispatch(char op, const Matrix & other, double & det) const{
+  switch(r){
+    case 1: return fixed<1>(op, other, det);
+    case 2: return fixed<2>(op, other, det);
+    case 3: return fixed<3>(op, other, det);
+    case 4: return fixed<4>(op, other, det);
+    case 5: return fixed<5>(op, other, det);
+    case 6: return fixed<6>(op, other, det);
+    case 7: return fixed<7>(op, other, det);
+    default: return fixed<8>(op, other, det);
+  }
+}
+//---------------------------------------------------------------------------------------
+template<size_t N>
+bool Matrix::isNegligible(const FixedMatrix<double, N, N> & m, double det){
+  double bound = 1;
+  for(size_t i = 0; i < N; ++i){
+    double sum = 0;
+    for(size_t j = 0; j < N; ++j)
+      sum += m(i, j) * m(i, j);
+    bound *= sqrt(sum);
+  }
+  return fabs(det) <= bound * N * numeric_limits<double>::epsilon();
+}
+//---------------------------------------------------------------------------------------
+template<size_t N>
+void Matrix::fixedBatch(char op, const vector<Matrix> & matrices, const vector<size_t> & which,
+                        vector<Matrix> & inverses, vector<double> & dets){
+  //batch of a few hundred matrices stays in cache while it is filled, computed and read
+  const size_t lanes = 256;
+  for(size_t first = 0; first < which.size(); first += lanes){
+    size_t count = min(lanes, which.size() - first);
+    const size_t * index = &which[first];
+    FixedBatch<double, N> batch(count), inv(0);
+    vector<FixedMatrix<double, N, N> > a(count);
+    for(size_t b = 0; b < count; ++b){
+      a[b] = matrices[index[b]].toFixed<N>();
+      batch.setMatrix(b, a[b]);
+    }
+    vector<double> det;
+    if(op == 'd')
+      det = batch.determinants();
+    else
+      inv = batch.inverses(det);
+    for(size_t b = 0; b < count; ++b){
+      bool negligible = isNegligible<N>(a[b], det[b]);
+      if(op == 'd')
+        dets[index[b]] = negligible ? 0 : det[b];
+      else if(negligible)
+        throw MatrixException(SINGULAR);
+      else
+        inverses[index[b]] = fromFixed<N>(inv.getMatrix(b), matrices[index[b]].isSingle);
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+void Matrix::fixedBatchDispatch(char op, const vector<Matrix> & matrices, vector<Matrix> & inverses,
+                                vector<double> & dets){
+  vector<vector<size_t> > groups(FIXED_BATCH_SIZE + 1);
+  for(size_t i = 0; i < matrices.size(); ++i){
+    const Matrix & m = matrices[i];
+    //exact determinant of integer matrix and other storages keep their own paths
+    if(m.r == m.c && m.r <= FIXED_BATCH_SIZE && m.isGeneral() && !m.isBinary
+       && !(op == 'd' && exact && m.isDense && Modular::isIntegral(*m.matrix)))
+      groups[m.r].push_back(i);
+    else if(op == 'd')
+      dets[i] = m.determinant();
+    else
+      inverses[i] = m.inverse();
+  }
+  for(size_t n = 1; n <= FIXED_BATCH_SIZE; ++n){
+    if(groups[n].empty())
+      continue;
+    switch(n){
+      case 1: fixedBatch<1>(op, matrices, groups[n], inverses, dets); break;
+      case 2: fixedBatch<2>(op, matrices, groups[n], inverses, dets); break;
+      case 3: fixedBatch<3>(op, matrices, groups[n], inverses, dets); break;
+      default: fixedBatch<4>(op, matrices, groups[n], inverses, dets); break;
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+vector<Matrix> Matrix::inverseBatch(const vector<Matrix> & matrices){
+  vector<Matrix> inverses(matrices);
+  vector<double> dets;
+  fixedBatchDispatch('i', matrices, inverses, dets);
+  return inverses;
+}
+//---------------------------------------------------------------------------------------
+vector<double> Matrix::determinantBatch(const vector<Matrix> & matrices){
+  vector<Matrix> inverses;
+  vector<double> dets(matrices.size());
+  fixedBatchDispatch('d', matrices, inverses, dets);
+  return dets;
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::operator *(const Matrix & other) const{
   if(c != other.r)
     throw MatrixException(DIMENSION);
-  MatrixType * tmp = new SparseMatrix(r, other.c);
-  for(size_t i = 0; i < r; ++i)
-    for(size_t j = 0; j < other.c; ++j){
-      double val = 0;
-      for(size_t k = 0; k < c; ++k)
-        val += matrix->getValue(i, k) * other.matrix->getValue(k, j);
-      tmp->setValue(i, j, val);
+  if(binaryWith(other))
+    return Matrix(r, other.c, bits().multiply(other.bits()), false);
+  if(structure == structures::BANDED || other.structure == structures::BANDED){
+    if(isBand() && other.isBand())
+      return multiplyBands(other);
+    const Matrix & m = structure == structures::BANDED ? other : *this;
+    if(m.isDense)
+      return m.isSingle ? multiplyBanded<float>(other) : multiplyBanded<double>(other);
+  }
+  if(structure == structures::DIAGONAL || other.structure == structures::DIAGONAL)
+    return multiplyDiagonal(other);
+  if(structure == structures::SYMMETRIC && other.isDense)
+    return other.isSingle ? multiplySymmetric<float>(other) : multiplySymmetric<double>(other);
+  if(!isGeneral() || !other.isGeneral())
+    return materialize() * other.materialize();
+  double det;
+  if(r == c && r == other.c && r <= FIXED_SIZE)
+    return fixedDispatch('*', other, det);
+  if(isDense && other.isDense && isSingle == other.isSingle)
+    return isSingle ? multiplyDense<float>(other) : multiplyDense<double>(other);
+  //product of dense matrices with different precisions is dense in double precision
+  if(isDense && other.isDense)
+    return isSingle ? toDouble() * other : *this * other.toDouble();
+  //rows of the result are accumulated from rows of the other matrix (Gustavson), element
+  //of the product is zero if no pair of non-zero elements meets
+  double meet = (1 - expectedZeros()) * (1 - other.expectedZeros());
+  MatrixType * tmp = newStorage(r, other.c, pow(1 - meet, c), isSingle && other.isSingle);
+  vector<double> acc(other.c, 0);
+  vector<bool> used(other.c, false);
+  vector<size_t> cols;
+  vector<pair<size_t, double>> row;
+  for(size_t i = 0; i < r; ++i){
+    cols.clear();
+    matrix->forEachNonZeroInRow(i, [&](size_t k, double a){
+      other.matrix->forEachNonZeroInRow(k, [&](size_t j, double b){
+        if(!used[j]){
+          used[j] = true;
+          cols.push_back(j);
+        }
+        acc[j] += a * b;
+      });
+    });
+    sort(cols.begin(), cols.end());
+    row.clear();
+    for(size_t j : cols){
+      if(acc[j] != 0)
+        row.emplace_back(j, acc[j]);
+      acc[j] = 0;
+      used[j] = false;
     }
-  return Matrix(r, other.c, tmp);
+    tmp->setRowValues(i, row);
+  }
+  return Matrix(r, other.c, tmp, isSingle && other.isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix operator *(double x, const Matrix & m){
-  MatrixType * tmp = new SparseMatrix(m.r, m.c);
-  for(size_t i = 0; i < m.r; ++i)
-    for(size_t j = 0; j < m.c; ++j)
-      tmp->setValue(i, j, x * m.matrix->getValue(i, j));
-  return Matrix(m.r, m.c, tmp);
+  if(m.isBinary){
+    if(x != floor(x))
+      throw MatrixException("Scalar is not integral!");
+    return fmod(x, 2) != 0 ? m : Matrix(m.r, m.c, new BitMatrix(m.r, m.c), false);
+  }
+  if(m.structure != structures::GENERAL){
+    const StructuredMatrix * s = static_cast<const StructuredMatrix *>(m.matrix.get());
+    StructuredMatrix * tmp = s->makeZero();
+    const vector<double> & a = s->getData();
+    for(size_t i = 0; i < a.size(); ++i)
+      tmp->getData()[i] = x * a[i];
+    return Matrix(m.r, m.c, tmp, m.isSingle);
+  }
+  MatrixType * tmp = Matrix::newStorage(m.r, m.c, x == 0 ? 1 : m.expectedZeros(), m.isSingle);
+  m.matrix->forEachNonZero([tmp, x](size_t i, size_t j, double y){
+    tmp->setValue(i, j, x * y);
+  });
+  return Matrix(m.r, m.c, tmp, m.isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::operator -(const Matrix & other) const{
   return *this + (-1 * other);
 }
 //---------------------------------------------------------------------------------------
+Matrix Matrix::addTransposed(const Matrix & other, double x) const{
+  if(r != other.c || c != other.r)
+    throw MatrixException(DIMENSION);
+  if(binaryWith(other))
+    return *this + other.transpose();
+  MatrixType * tmp = newStorage(r, c, expectedZeros() * other.expectedZeros(), isSingle && other.isSingle);
+  matrix->forEachNonZero([tmp](size_t i, size_t j, double y){
+    tmp->setValue(i, j, y);
+  });
+  other.matrix->forEachNonZero([tmp, x](size_t i, size_t j, double y){
+    tmp->setValue(j, i, tmp->getValue(j, i) + x * y);
+  });
+  return Matrix(r, c, tmp, isSingle && other.isSingle);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::operator +(const Transposed & other) const{
+  return addTransposed(other.getMatrix(), 1);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::operator -(const Transposed & other) const{
+  return addTransposed(other.getMatrix(), -1);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::operator *(const Transposed & other) const{
+  const Matrix & b = other.getMatrix();
+  if(c != b.c)
+    throw MatrixException(DIMENSION);
+  if(binaryWith(b))
+    return *this * b.transpose();
+  if(&b == this && isDense && r > FIXED_SIZE)
+    return isSingle ? multiplyGram<float>() : multiplyGram<double>();
+  if(!isGeneral() || !b.isGeneral())
+    return materialize() * b.materialize().transposed();
+  if(isDense && b.isDense && isSingle == b.isSingle)
+    return isSingle ? multiplyTransposed<float>(b, false) : multiplyTransposed<double>(b, false);
+  return *this * b.transpose();
+}
+//---------------------------------------------------------------------------------------
+Matrix operator *(const Transposed & a, const Matrix & b){
+  const Matrix & m = a.getMatrix();
+  if(m.r != b.r)
+    throw MatrixException(Matrix::DIMENSION);
+  if(m.binaryWith(b))
+    return m.transpose() * b;
+  if(!m.isGeneral() || !b.isGeneral())
+    return m.materialize().transposed() * b.materialize();
+  if(m.isDense && b.isDense && m.isSingle == b.isSingle)
+    return m.isSingle ? m.multiplyTransposed<float>(b, true) : m.multiplyTransposed<double>(b, true);
+  return m.transpose() * b;
+}
+//---------------------------------------------------------------------------------------
 Matrix & Matrix::operator =(double x){
+  detach();
+  factorization.reset();
   for(size_t i = 0; i < r; ++i)
     matrix->setValue(i, i, x);
+  //array of the caller keeps dense storage
+  if(isAdopted())
+    return *this;
   checkCountOfZeros();
+  checkStructure();
+  return *this;
+}
+//---------------------------------------------------------------------------------------
+Matrix & Matrix::addInPlace(const Matrix & other, bool subtract){
+  if(r != other.r || c != other.c)
+    throw MatrixException(DIMENSION);
+  //sparse storage cannot change while its elements are visited, dense array can
+  if(this == &other && !isDense)
+    return addInPlace(Matrix(other), subtract);
+  if(structure != structures::GENERAL || (isSingle && !other.isSingle) || isBinary || other.isBinary)
+    return assign(subtract ? *this - other : *this + other);
+  detach();
+  factorization.reset();
+  double sign = subtract ? -1 : 1;
+  if(!other.isDense){
+    MatrixType * a = matrix.get();
+    other.matrix->forEachNonZero([a, sign](size_t i, size_t j, double x){
+      a->setValue(i, j, a->getValue(i, j) + sign * x);
+    });
+  }
+  else if(isDense && other.isDense && isSingle == other.isSingle){
+    if(isSingle){
+      float * a = static_cast<FloatMatrix *>(matrix.get())->getData();
+      const float * b = static_cast<const FloatMatrix *>(other.matrix.get())->getData();
+      for(size_t i = 0; i < r * c; ++i)
+        a[i] += sign * b[i];
+    }
+    else{
+      double * a = static_cast<DenseMatrix *>(matrix.get())->getData();
+      const double * b = static_cast<const DenseMatrix *>(other.matrix.get())->getData();
+      for(size_t i = 0; i < r * c; ++i)
+        a[i] += sign * b[i];
+    }
+  }
+  else{
+    MatrixType * a = matrix.get();
+    other.matrix->forEachNonZero([a, sign](size_t i, size_t j, double x){
+      a->setValue(i, j, a->getValue(i, j) + sign * x);
+    });
+  }
+  //ratio of zeros of sparse storage is known without a scan
+  if(!isDense)
+    checkCountOfZeros();
   return *this;
 }
 //---------------------------------------------------------------------------------------
 Matrix & Matrix::operator +=(const Matrix & other){
-  return (*this = *this + other);
+  return addInPlace(other, false);
 }
 //---------------------------------------------------------------------------------------
 Matrix & Matrix::operator -=(const Matrix & other){
-  return (*this = *this - other);
+  return addInPlace(other, true);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void Matrix::multiplyInPlace(const Matrix & other){
+  static thread_local vector<T> work;
+  work.assign(r * c, 0);
+  const T * a = static_cast<const BasicDenseMatrix<T> *>(matrix.get())->getData(),
+          * b = static_cast<const BasicDenseMatrix<T> *>(other.matrix.get())->getData();
+  if(strassen && min(r, c) > Kernels::STRASSEN_CROSSOVER)
+    ProcessPool::getInstance().strassen<T>(r, c, c, a, c, b, c, work.data(), c);
+  else
+    ProcessPool::getInstance().gemm<T>(r, c, c, 1, a, c, b, c, work.data(), c);
+  //old elements are not needed, so shared storage is replaced and not copied
+  if(matrix.use_count() > 1)
+    matrix.reset(newStorage(true));
+  copy(work.begin(), work.end(), static_cast<BasicDenseMatrix<T> *>(matrix.get())->getData());
+  factorization.reset();
 }
 //---------------------------------------------------------------------------------------
 Matrix & Matrix::operator *=(const Matrix & other){
-  return (*this = *this * other);
+  if(c != other.r)
+    throw MatrixException(DIMENSION);
+  if(other.r != other.c || !isDense || !other.isDense || isSingle != other.isSingle
+     || (r == c && r <= FIXED_SIZE))
+    return assign(*this * other);
+  if(isSingle)
+    multiplyInPlace<float>(other);
+  else
+    multiplyInPlace<double>(other);
+  return *this;
 }
 //---------------------------------------------------------------------------------------
 Matrix & operator *=(Matrix & m, double x){
-  return (m = x * m);
+  if(m.structure != structures::GENERAL || m.isBinary)
+    return (m = x * m);
+  m.detach();
+  m.factorization.reset();
+  if(x == 0 && m.isAdopted()){
+    if(m.isSingle)
+      fill_n(static_cast<FloatMatrix *>(m.matrix.get())->getData(), m.r * m.c, 0.0f);
+    else
+      fill_n(static_cast<DenseMatrix *>(m.matrix.get())->getData(), m.r * m.c, 0.0);
+  }
+  else if(x == 0){
+    m.isDense = false;
+    m.matrix.reset(new SparseMatrix(m.r, m.c));
+  }
+  else if(!m.isDense)
+    static_cast<SparseMatrix *>(m.matrix.get())->scale(x);
+  else if(m.isSingle){
+    float * a = static_cast<FloatMatrix *>(m.matrix.get())->getData();
+    for(size_t i = 0; i < m.r * m.c; ++i)
+      a[i] = x * a[i];
+  }
+  else{
+    double * a = static_cast<DenseMatrix *>(m.matrix.get())->getData();
+    for(size_t i = 0; i < m.r * m.c; ++i)
+      a[i] *= x;
+  }
+  return m;
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::merge(const Matrix & other) const{
   if(r != other.r)
     throw MatrixException(DIMENSION);
-  MatrixType * tmp = new SparseMatrix(r, c + other.c);
-  for(size_t i = 0; i < r; ++i){
-    for(size_t j = 0; j < c; ++j)
-      tmp->setValue(i, j, matrix->getValue(i, j));
-    for(size_t j = 0; j < other.c; ++j)
-      tmp->setValue(i, j + c, other.matrix->getValue(i, j));
+  if(binaryWith(other)){
+    BitMatrix * tmp = new BitMatrix(r, c + other.c);
+    matrix->forEachNonZero([tmp](size_t i, size_t j, double x){ tmp->setValue(i, j, x); });
+    size_t cols = c;
+    other.matrix->forEachNonZero([tmp, cols](size_t i, size_t j, double x){ tmp->setValue(i, cols + j, x); });
+    return Matrix(r, c + other.c, tmp, false);
   }
-  return Matrix(r, c + other.c, tmp);
+  //too deep views are copied, so reading an element stays cheap
+  Matrix left = MatrixView::getDepth(*matrix) < MatrixView::MAX_DEPTH ? *this : materialize();
+  Matrix right = MatrixView::getDepth(*other.matrix) < MatrixView::MAX_DEPTH ? other : other.materialize();
+  return Matrix(r, c + other.c, make_shared<ConcatenatedMatrix>(left.matrix, right.matrix), isSingle && other.isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::split(size_t newR, size_t newC, size_t posR, size_t posC) const{
-  if(posR + newR - 1 > r || posC + newC - 1 > c)
+  if(newR == 0 || newC == 0 || posR + newR > r || posC + newC > c)
     throw MatrixException(DIMENSION);
-  MatrixType * tmp = new SparseMatrix(newR, newC);
-  for(size_t i = 0; i < newR; ++i)
-    for(size_t j = 0; j < newC; ++j)
-      tmp->setValue(i, j, matrix->getValue(posR + i, posC + j));
-  return Matrix(newR, newC, tmp);
+  if(isBinary){
+    BitMatrix * tmp = new BitMatrix(newR, newC);
+    SubMatrix(matrix, newR, newC, posR, posC).forEachNonZero([tmp](size_t i, size_t j, double x){
+      tmp->setValue(i, j, x);
+    });
+    return Matrix(newR, newC, tmp, false);
+  }
+  return Matrix(newR, newC, SubMatrix::make(matrix, newR, newC, posR, posC), isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::gem(gemStates printDetail, double & out) const{
-  MatrixType * tmp = new SparseMatrix(r, c);
-  copyMatrix(matrix, tmp);
+  if(isBinary){
+    //steps are not printed, elimination over GF(2) works with whole words
+    Matrix tmp(r, c, bits().echelon(), false);
+    out = r == c && tmp.matrix->countZeroRows() == r ? 1 : 0;
+    return tmp;
+  }
+  if(!isGeneral())
+    return materialize().gem(printDetail, out);
+  //elimination is done in double precision
+  MatrixType * tmp = isDense ? (MatrixType *) new DenseMatrix(r, c) : new SparseMatrix(r, c);
+  copyMatrix(matrix.get(), tmp);
   Gem g(r, c, tmp, printDetail);
   g.gem();
   out = g.getDeterminant();
-  return Matrix(r, c, tmp);
+  return Matrix(r, c, tmp, isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::gem(gemStates printDetail) const{
@@ -165,39 +1048,211 @@ Matrix Matrix::gem(gemStates printDetail) const{
   return gem(printDetail, tmp);
 }
 //---------------------------------------------------------------------------------------
+const Factorization & Matrix::factorize() const{
+  shared_ptr<Factorization> f = atomic_load(&factorization);
+  if(f)
+    return *f;
+  const SparseMatrix * sparse = dynamic_cast<const SparseMatrix *>(matrix.get());
+  if(structure == structures::DIAGONAL || structure == structures::UPPER || structure == structures::LOWER)
+    f = make_shared<TriangularSolver>(static_pointer_cast<const StructuredMatrix>(matrix));
+  else if(structure == structures::BANDED)
+    f = make_shared<BandLU>(*static_cast<const StructuredMatrix *>(matrix.get()));
+  else if(sparse)
+    f = make_shared<SparseLU>(*sparse);
+  else if(isSingle)
+    f = make_shared<FloatLU>(*matrix, blockSize);
+  else
+    f = make_shared<LU>(*matrix, blockSize);
+  //matrix can be factored by two threads at once, the first stored factorization is kept
+  shared_ptr<Factorization> stored;
+  if(!atomic_compare_exchange_strong(&factorization, &stored, f))
+    return *stored;
+  return *f;
+}
+//---------------------------------------------------------------------------------------
 unsigned int Matrix::rank() const{
+  if(isBinary)
+    return bits().rank();
+  if(isView || structure == structures::SYMMETRIC)
+    return materialize().rank();
+  if(structure == structures::DIAGONAL){
+    const vector<double> & d = static_cast<const StructuredMatrix *>(matrix.get())->getData();
+    return r - count(d.begin(), d.end(), 0.0);
+  }
+  if(exact && isDense && Modular::isIntegral(*matrix))
+    return Modular(*matrix).rank();
+  const Factorization & f = factorize();
+  const SparseLU * sparse = dynamic_cast<const SparseLU *>(&f);
+  if(sparse)
+    return sparse->getRank();
+  if(!f.isSingular())
+    return min(r, c);
   Matrix tmp = gem();
   return tmp.matrix->countZeroRows();
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::transpose() const{
-  MatrixType * tmp = new SparseMatrix(c, r);
-  for(size_t i = 0; i < c; ++i)
-    for(size_t j = 0; j < r; ++j)
-      tmp->setValue(i, j, matrix->getValue(j, i));
-  return Matrix(c, r, tmp);
+  if(isBinary)
+    return Matrix(c, r, bits().transpose(), false);
+  if(structure == structures::DIAGONAL || structure == structures::SYMMETRIC)
+    return *this;
+  if(structure == structures::BANDED)
+    return Matrix(c, r, static_cast<const BandMatrix *>(matrix.get())->transpose(), isSingle);
+  if(structure != structures::GENERAL)
+    return Matrix(c, r, static_cast<const TriangularMatrix *>(matrix.get())->transpose(), isSingle);
+  if(isView)
+    return materialize().transpose();
+  if(isDense)
+    return isSingle ? transposeDense<float>() : transposeDense<double>();
+  return Matrix(c, r, static_cast<const SparseMatrix *>(matrix.get())->transpose(), isSingle);
+}
+//---------------------------------------------------------------------------------------
+Transposed Matrix::transposed() const{
+  return Transposed(*this);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::reorder(vector<size_t> & perm, orderings method) const{
+  if(r != c)
+    throw MatrixException(DIMENSION);
+  if(!isGeneral())
+    return materialize().reorder(perm, method);
+  Ordering ordering(*matrix);
+  perm = method == orderings::RCM ? ordering.reverseCuthillMcKee() : ordering.nestedDissection();
+  return permute(perm);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::permute(const vector<size_t> & perm) const{
+  if(r != c || perm.size() != r)
+    throw MatrixException(DIMENSION);
+  if(!isGeneral())
+    return materialize().permute(perm);
+  //position[i] is the new index of i-th row and column
+  vector<size_t> position(r, r);
+  for(size_t i = 0; i < r; ++i){
+    if(perm[i] >= r || position[perm[i]] != r)
+      throw MatrixException("Wrong permutation!");
+    position[perm[i]] = i;
+  }
+  MatrixType * tmp = newStorage(isDense);
+  matrix->forEachNonZero([tmp, &position](size_t i, size_t j, double x){
+    tmp->setValue(position[i], position[j], x);
+  });
+  return Matrix(r, c, tmp, isSingle);
 }
 //---------------------------------------------------------------------------------------
 Matrix Matrix::inverse() const{
   if(r != c)
     throw MatrixException(DIMENSION);
-  if(rank() != r)
+  if(isBinary){
+    BitMatrix identity(r, c);
+    for(size_t i = 0; i < r; ++i)
+      identity.setValue(i, i, 1);
+    BitMatrix * tmp = bits().solve(identity);
+    if(!tmp)
+      throw MatrixException(SINGULAR);
+    return Matrix(r, c, tmp, false);
+  }
+  if(isView)
+    return materialize().inverse();
+  if(structure == structures::DIAGONAL){
+    DiagonalMatrix * tmp = new DiagonalMatrix(r);
+    const vector<double> & d = static_cast<const StructuredMatrix *>(matrix.get())->getData();
+    for(size_t i = 0; i < r; ++i){
+      if(d[i] == 0){
+        delete tmp;
+        throw MatrixException(SINGULAR);
+      }
+      tmp->getData()[i] = 1 / d[i];
+    }
+    return Matrix(r, c, tmp, isSingle);
+  }
+  if(structure == structures::SYMMETRIC){
+    //rounding makes the inverse slightly asymmetric, the average is symmetric again
+    Matrix x = materialize().inverse();
+    SymmetricMatrix * tmp = new SymmetricMatrix(r);
+    for(size_t i = 0; i < r; ++i)
+      for(size_t j = i; j < c; ++j)
+        tmp->setValue(i, j, (x.matrix->getValue(i, j) + x.matrix->getValue(j, i)) / 2);
+    return Matrix(r, c, tmp, isSingle);
+  }
+  double det;
+  if(r <= FIXED_SIZE)
+    return fixedDispatch('i', *this, det);
+  const Factorization & f = factorize();
+  if(f.isSingular())
     throw MatrixException(SINGULAR);
-  Matrix e(r, c);
-  e = 1;
-  Matrix tmp = *this;
-  tmp = tmp.merge(e).gem().split(r, c, 0, c);
-  return tmp;
+  vector<double> e(r * c, 0);
+  for(size_t i = 0; i < r; ++i)
+    e[i * c + i] = 1;
+  f.solve(e, c);
+  return fromArray(r, c, e, isSingle);
 }
 //---------------------------------------------------------------------------------------
 double Matrix::determinant() const{
   if(r != c)
     throw MatrixException(DIMENSION);
-  if(rank() != r)
-    return 0;
-  double out = 1;
-  Matrix tmp = gem(gemStates::NO_DETAILS, out);
-  return out;
+  if(isBinary)
+    return bits().rank() == r ? 1 : 0;
+  if(isView || structure == structures::SYMMETRIC)
+    return materialize().determinant();
+  if(exact && isDense && Modular::isIntegral(*matrix)){
+    Modular m(*matrix);
+    if(m.getDeterminantBits() <= Modular::MAX_BITS)
+      return m.determinant();
+  }
+  else if(r <= FIXED_SIZE){
+    double det;
+    fixedDispatch('d', *this, det);
+    return det;
+  }
+  return factorize().getDeterminant();
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::solve(const Matrix & b) const{
+  if(r != c || b.r != r)
+    throw MatrixException(DIMENSION);
+  if(binaryWith(b)){
+    BitMatrix * tmp = bits().solve(b.bits());
+    if(!tmp)
+      throw MatrixException(SINGULAR);
+    return Matrix(r, b.c, tmp, false);
+  }
+  if(isView || structure == structures::SYMMETRIC)
+    return materialize().solve(b);
+  const Factorization & f = factorize();
+  if(f.isSingular())
+    throw MatrixException(SINGULAR);
+  vector<double> x(r * b.c);
+  for(size_t i = 0; i < r; ++i)
+    for(size_t j = 0; j < b.c; ++j)
+      x[i * b.c + j] = b.matrix->getValue(i, j);
+  f.solve(x, b.c);
+  return fromArray(r, b.c, x, isSingle);
+}
+//---------------------------------------------------------------------------------------
+Matrix Matrix::solve(const Matrix & b, krylovMethods method, preconditioners precond, double tolerance,
+                     size_t maxIterations, size_t & iterations, double & residual) const{
+  if(r != c || b.r != r)
+    throw MatrixException(DIMENSION);
+  if(isBinary || b.isBinary)
+    throw MatrixException("Iterative methods do not work over GF(2)!");
+  if(!isGeneral())
+    return materialize().solve(b, method, precond, tolerance, maxIterations, iterations, residual);
+  IterativeSolver solver(*matrix, method, precond, tolerance, maxIterations);
+  iterations = 0;
+  residual = 0;
+  vector<double> rhs(r), x, out(r * b.c);
+  for(size_t j = 0; j < b.c; ++j){
+    for(size_t i = 0; i < r; ++i)
+      rhs[i] = b.matrix->getValue(i, j);
+    x.assign(r, 0);
+    solver.solve(rhs, x);
+    iterations = max(iterations, solver.getIterations());
+    residual = max(residual, solver.getResidual());
+    for(size_t i = 0; i < r; ++i)
+      out[i * b.c + j] = x[i];
+  }
+  return fromArray(r, b.c, out, isSingle);
 }
 //---------------------------------------------------------------------------------------
 ostream & operator <<(ostream & os, const Matrix & x){
@@ -205,7 +1260,10 @@ ostream & operator <<(ostream & os, const Matrix & x){
 }
 //---------------------------------------------------------------------------------------
 istream & operator >>(istream & is, Matrix & x){
+  x.detach();
+  x.factorization.reset();
   is >> *(x.matrix);
   x.checkCountOfZeros();
+  x.checkStructure();
   return is;
 }
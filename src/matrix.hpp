@@ -1,12 +1,50 @@
 #ifndef MATRIX_HPP
 #define MATRIX_HPP
 
+#include <memory>
+#include <atomic>
 #include "matrixType.hpp"
 #include "denseMatrix.hpp"
 #include "sparseMatrix.hpp"
+#include "bitMatrix.hpp"
+#include "matrixView.hpp"
+#include "structuredMatrix.hpp"
 #include "gem.hpp"
+#include "kernels.hpp"
+#include "lu.hpp"
+#include "sparseLU.hpp"
+#include "triangularSolver.hpp"
+#include "bandLU.hpp"
+#include "iterativeSolver.hpp"
+#include "modular.hpp"
+#include "ordering.hpp"
+#include "fixedMatrix.hpp"
 #include "matrixException.hpp"
 
+class Matrix;
+
+/**
+  * @brief Transposed matrix which is not stored.
+  * View only refers to the original matrix and operators read its elements with swapped
+  * indices, so no copy is made. Original matrix must exist as long as the view is used.
+  * @sa Matrix::transposed
+  */
+class Transposed{
+  private:
+    const Matrix & m; ///< Original matrix.
+  public:
+    /**
+      * @brief Constructs view of transposed matrix.
+      * @param m original matrix
+      */
+    explicit Transposed(const Matrix & m);
+    /**
+      * @brief Returns original matrix.
+      * @return original matrix
+      */
+    const Matrix & getMatrix() const;
+};
+
 /**
   * @brief Main class which handles matrix functions.
   */
@@ -15,17 +53,62 @@ class Matrix{
     size_t r, ///< Number of rows.
            c; ///< Number of columns.
     bool isDense = false; ///< Density.
-    MatrixType * matrix; ///< Matrix.
+    bool isSingle = false; ///< Dense elements are stored in single precision.
+    bool isView = false; ///< Matrix is a MatrixView of other matrices.
+    bool isBinary = false; ///< Elements are in GF(2) and stored in BitMatrix.
+    structures structure = structures::GENERAL; ///< Structure of StructuredMatrix storage.
+    /**
+      * @brief Matrix.
+      * Copies of the matrix share the storage, it is copied before the first change.
+      */
+    std::shared_ptr<MatrixType> matrix;
+    /**
+      * @brief Factorization of matrix computed by the first operation which needed it.
+      * Copies of the matrix share the factorization, every change of elements drops it.
+      * It is accessed atomically, so const methods can be called from several threads.
+      */
+    mutable std::shared_ptr<Factorization> factorization;
     
     ///Error message for wrong dimensions.
     static const char * DIMENSION;
     ///Error message for singular matrix.
     static const char * SINGULAR;
+    ///Error message for operands over GF(2) and over reals.
+    static const char * FIELD;
     /**
       * @brief Treshold of density.
       * If ratio of zeros is greater than this treshold then sparse matrix is used.
       */
     static const double DENSITY_TRESHOLD;
+    /**
+      * @brief Largest dimension of square matrices handled by FixedMatrix.
+      */
+    static const size_t FIXED_SIZE;
+    /**
+      * @brief Largest dimension of square matrices computed together by FixedBatch.
+      * Closed forms exist up to 4 x 4, bigger matrices need pivoting of their own.
+      */
+    static const size_t FIXED_BATCH_SIZE;
+    /**
+      * @brief Square matrices whose band is at most 1/BAND_RATIO of their dimension are
+      * stored in BandMatrix.
+      */
+    static const size_t BAND_RATIO;
+    /**
+      * @brief Number of columns in one panel of blocked LU factorization.
+      * @sa LU, setBlockSize
+      */
+    static std::atomic<size_t> blockSize;
+    /**
+      * @brief Whether rank and determinant of dense integer matrices are computed exactly.
+      * @sa Modular, setExact
+      */
+    static std::atomic<bool> exact;
+    /**
+      * @brief Whether big dense products use Strassen-Winograd algorithm.
+      * @sa Kernels::strassen, setStrassen
+      */
+    static std::atomic<bool> strassen;
     
     /**
       * @brief Checks ratio of zeros in matrix.
@@ -39,12 +122,306 @@ class Matrix{
       * @sa copyMatrix
       */
     void useOtherTypeOfMatrix();
+    /**
+      * @brief Checks structure of square matrix.
+      * Diagonal matrices get DiagonalMatrix storage, other matrices with a narrow band get
+      * BandMatrix storage and dense triangular and symmetric matrices get packed
+      * TriangularMatrix or SymmetricMatrix storage. Matrices up to FIXED_SIZE keep
+      * general storage.
+      * @sa StructuredMatrix::detect, BandMatrix::findBand, BAND_RATIO
+      */
+    void checkStructure();
+    /**
+      * @brief Tells whether storage is DenseMatrix, FloatMatrix or SparseMatrix.
+      * @return false for views and structured storages
+      */
+    bool isGeneral() const;
     /**
       * @brief Makes copy of matrix.
       * @param src source
       * @param[out] out destination
       */
     void copyMatrix(MatrixType * const & src, MatrixType *& out) const;
+    /**
+      * @brief Allocates storage with dimensions of this matrix.
+      * Dense storage has precision of this matrix, sparse storage is always in double
+      * precision.
+      * @param dense dense or sparse storage
+      * @return new storage
+      */
+    MatrixType * newStorage(bool dense) const;
+    /**
+      * @brief Allocates storage for result with expected ratio of zeros.
+      * Storage is the one which checkCountOfZeros would keep, so a good estimate means
+      * that the result is written only once.
+      * @param r rows
+      * @param c columns
+      * @param zeros expected ratio of zero elements
+      * @param single precision of dense storage
+      * @return new storage
+      */
+    static MatrixType * newStorage(size_t r, size_t c, double zeros, bool single);
+    /**
+      * @brief Tells whether operation works over GF(2).
+      * @param other other operand
+      * @return true if both matrices are over GF(2), false if none is
+      * @throw MatrixException if only one matrix is over GF(2)
+      */
+    bool binaryWith(const Matrix & other) const;
+    /**
+      * @brief Returns storage of matrix over GF(2).
+      * @return storage
+      */
+    const BitMatrix & bits() const;
+    /**
+      * @brief Makes matrix from array of elements stored by rows.
+      * Zeros are counted first, so the storage is chosen before elements are written.
+      * @param r rows
+      * @param c columns
+      * @param data elements
+      * @param single single precision
+      * @return matrix
+      */
+    static Matrix fromArray(size_t r, size_t c, const std::vector<double> & data, bool single);
+    /**
+      * @brief Makes dense matrix in array of the caller.
+      * @param r rows
+      * @param c columns
+      * @param data elements stored by rows
+      * @return matrix
+      * @sa adopt
+      */
+    template<typename T>
+    static Matrix adoptDense(size_t r, size_t c, T * data);
+    /**
+      * @brief Returns ratio of zeros for estimates of results.
+      * Sparse and structured storages know it without a scan. DenseMatrix and
+      * FloatMatrix are taken as full, they keep matrices with few zeros anyway.
+      * @return ratio of zeros
+      */
+    double expectedZeros() const;
+    /**
+      * @brief Constructor with given precision.
+      * Dense storage which does not match the precision is converted. StructuredMatrix
+      * storage is kept as it is.
+      * @param r rows
+      * @param c columns
+      * @param data matrix
+      * @param single single precision
+      * @param detect check structure of matrix
+      * @sa Matrix(size_t, size_t, MatrixType *), checkStructure
+      */
+    Matrix(size_t r, size_t c, MatrixType * data, bool single, bool detect = true);
+    /**
+      * @brief Constructs view of other matrices.
+      * Ratio of zero elements is not checked, view is kept until it is changed or until
+      * some operation needs stored elements.
+      * @param r rows
+      * @param c columns
+      * @param view view
+      * @param single single precision
+      * @sa MatrixView
+      */
+    Matrix(size_t r, size_t c, const std::shared_ptr<MatrixType> & view, bool single);
+    /**
+      * @brief Returns matrix with general storage.
+      * View or structured matrix is copied to dense or sparse storage according to its
+      * ratio of zeros, other matrices are returned as they are.
+      * @return matrix with general storage
+      */
+    Matrix materialize() const;
+    /**
+      * @brief Makes storage of this matrix its own before it is changed.
+      * View and structured matrix are materialized and storage shared with other
+      * matrices is copied.
+      */
+    void detach();
+    /**
+      * @brief Tells whether elements are stored in array of the caller.
+      * @return true if matrix has dense storage made by adopt otherwise false
+      */
+    bool isAdopted() const;
+    /**
+      * @brief Sets this matrix to result of an operation on it.
+      * Array of the caller adopted by a matrix whose storage is not shared keeps the
+      * elements of the result in the precision of the array, otherwise the result
+      * replaces this matrix.
+      * @param result result of the same dimensions
+      * @return this
+      */
+    Matrix & assign(const Matrix & result);
+    /**
+      * @brief Multiplies two dense matrices with elements of type T.
+      * Product is computed by Kernels::gemm directly on arrays of both matrices.
+      * @param other other matrix
+      * @return product
+      */
+    template<typename T>
+    Matrix multiplyDense(const Matrix & other) const;
+    /**
+      * @brief Multiplies two dense matrices with elements of type T when one of them is
+      * transposed.
+      * Product is computed by Kernels::gemmTN (left) or Kernels::gemmNT directly on arrays
+      * of both matrices, transposed matrix is never made.
+      * @param other other matrix
+      * @param left true for this<sup>T</sup> * other, false for this * other<sup>T</sup>
+      * @return product
+      */
+    template<typename T>
+    Matrix multiplyTransposed(const Matrix & other, bool left) const;
+    /**
+      * @brief Transposes dense matrix with elements of type T by Kernels::transpose.
+      * @return transposed matrix
+      */
+    template<typename T>
+    Matrix transposeDense() const;
+    /**
+      * @brief Multiplies matrices when one of them is diagonal.
+      * Rows (diagonal on the left) or columns (diagonal on the right) of the other
+      * matrix are scaled, only stored elements of sparse matrix are visited.
+      * @param other other matrix
+      * @return product
+      */
+    Matrix multiplyDiagonal(const Matrix & other) const;
+    /**
+      * @brief Multiplies this symmetric matrix by dense matrix with elements of type T.
+      * Every stored element is read once and used for two rows of the product, so only
+      * half of the matrix is read.
+      * @param other other matrix
+      * @return product
+      */
+    template<typename T>
+    Matrix multiplySymmetric(const Matrix & other) const;
+    /**
+      * @brief Computes this * this<sup>T</sup> for dense matrix with elements of type T.
+      * Product is symmetric, so only its upper triangle is computed and stored.
+      * @return product in SymmetricMatrix storage
+      */
+    template<typename T>
+    Matrix multiplyGram() const;
+    /**
+      * @brief Multiplies band matrix by dense matrix with elements of type T or vice versa.
+      * Only elements in the band are read, so the product costs O(nb) per column of the
+      * dense matrix where b is the width of the band.
+      * @param other other matrix
+      * @return product
+      */
+    template<typename T>
+    Matrix multiplyBanded(const Matrix & other) const;
+    /**
+      * @brief Multiplies two band or diagonal matrices.
+      * Bandwidths of the product are sums of bandwidths of the operands. If the band of
+      * the product is not narrow, product gets general storage.
+      * @param other other matrix
+      * @return product
+      */
+    Matrix multiplyBands(const Matrix & other) const;
+    /**
+      * @brief Adds two band or diagonal matrices.
+      * Bandwidths of the sum are the larger bandwidths of the operands.
+      * @param other other matrix
+      * @return sum in BandMatrix storage
+      */
+    Matrix addBands(const Matrix & other) const;
+    /**
+      * @brief Tells whether storage is BandMatrix or DiagonalMatrix.
+      * @return true for band and diagonal matrices
+      */
+    bool isBand() const;
+    /**
+      * @brief Adds or subtracts other matrix in place.
+      * @throw MatrixException
+      * @param other other matrix
+      * @param subtract subtract instead of add
+      * @return this
+      */
+    Matrix & addInPlace(const Matrix & other, bool subtract);
+    /**
+      * @brief Multiplies this dense matrix by dense square matrix with elements of type T
+      * in place.
+      * Product is computed to a workspace of the calling thread, which is kept for next
+      * calls, and then copied to the storage of this matrix.
+      * @param other other matrix
+      */
+    template<typename T>
+    void multiplyInPlace(const Matrix & other);
+    /**
+      * @brief Makes matrix this + x * other<sup>T</sup>.
+      * @throw MatrixException
+      * @param other other matrix
+      * @param x multiplier of other matrix
+      * @return sum
+      */
+    Matrix addTransposed(const Matrix & other, double x) const;
+    /**
+      * @brief Copies this matrix to FixedMatrix.
+      * Array of dense storage is copied at once, other storages give non-zero elements.
+      * @return fixed size matrix
+      */
+    template<size_t N>
+    FixedMatrix<double, N, N> toFixed() const;
+    /**
+      * @brief Makes matrix from FixedMatrix.
+      * Result is dense, zeros and structure are not checked.
+      * @param m fixed size matrix
+      * @param single single precision
+      * @return matrix
+      */
+    template<size_t N>
+    static Matrix fromFixed(const FixedMatrix<double, N, N> & m, bool single);
+    /**
+      * @brief Performs operation on N x N matrices by FixedMatrix.
+      * Operation is <b>*</b> (product with <i>other</i>), <b>d</b> (determinant stored
+      * in <i>det</i>) or <b>i</b> (inverse).
+      * @param op operation
+      * @param other second operand of product
+      * @param[out] det determinant
+      * @return result of product or inverse
+      */
+    template<size_t N>
+    Matrix fixed(char op, const Matrix & other, double & det) const;
+    /**
+      * @brief Chooses FixedMatrix dimension for operation.
+      * @param op operation
+      * @param other second operand of product
+      * @param[out] det determinant
+      * @return result of product or inverse
+      * @sa fixed, FIXED_SIZE
+      */
+    Matrix fixedDispatch(char op, const Matrix & other, double & det) const;
+    /**
+      * @brief Tells whether determinant of FixedMatrix would be numerically zero.
+      * Determinant is zero if it is not greater than machine precision multiplied by the
+      * dimension and by the Hadamard bound.
+      * @param m matrix
+      * @param det determinant
+      * @return true if determinant is numerically zero
+      */
+    template<size_t N>
+    static bool isNegligible(const FixedMatrix<double, N, N> & m, double det);
+    /**
+      * @brief Computes determinants or inverses of N x N matrices together by FixedBatch.
+      * @throw MatrixException if a matrix is singular
+      * @param op <b>d</b> (determinants) or <b>i</b> (inverses)
+      * @param matrices all matrices
+      * @param which indices of N x N matrices in <i>matrices</i>
+      * @param[out] inverses inverses at the same indices
+      * @param[out] dets determinants at the same indices
+      */
+    template<size_t N>
+    static void fixedBatch(char op, const std::vector<Matrix> & matrices, const std::vector<size_t> & which,
+                           std::vector<Matrix> & inverses, std::vector<double> & dets);
+    /**
+      * @brief Groups square general matrices up to FIXED_BATCH_SIZE by dimension for fixedBatch.
+      * Other matrices are computed one by one by determinant or inverse.
+      * @throw MatrixException
+      * @param op <b>d</b> (determinants) or <b>i</b> (inverses)
+      * @param matrices matrices
+      * @param[out] inverses inverses, the same size as <i>matrices</i> for <b>i</b>
+      * @param[out] dets determinants, the same size as <i>matrices</i> for <b>d</b>
+      */
+    static void fixedBatchDispatch(char op, const std::vector<Matrix> & matrices, std::vector<Matrix> & inverses,
+                                   std::vector<double> & dets);
     /**
       * @brief Performs Gaussian elimination method and computes determinant.
       * @param printDetails print details
@@ -53,13 +430,23 @@ class Matrix{
       * @sa Gem
       */
     Matrix gem(gemStates printDetails, double & out) const;
+    /**
+      * @brief Factors this matrix.
+      * Dense matrices are factored by blocked LU, sparse matrices by sparse LU and band
+      * matrices by band LU in O(nb<sup>2</sup>). Matrix is factored only once, later calls
+      * return the same factorization.
+      * @return factorization
+      * @sa LU, SparseLU, BandLU, TriangularSolver
+      */
+    const Factorization & factorize() const;
   public:
 
     /**
       * @brief Constructor.
       * If no matrix type is specified (data == NULL) then sparse matrix type is used and
       * all elements are equal to zero. Ratio of zero elements is checked. If no dimensions
-      * are set then 3x3 matrix is created.
+      * are set then 3x3 matrix is created. Matrix is in single precision if <i>data</i>
+      * is FloatMatrix.
       * @param r rows
       * @param c columns
       * @param data matrix
@@ -68,12 +455,13 @@ class Matrix{
     Matrix(size_t r = 3, size_t c = 3, MatrixType * data = NULL);
     /**
       * @brief Copy constructor.
-      * Ratio of zero elements is checked.
+      * Storage is shared with <i>other</i>, elements are not copied.
       * @param other source
       */
     Matrix(const Matrix & other);
     /**
       * @brief Operator =
+      * Storage is shared with <i>other</i>, elements are not copied.
       * @param other source
       * @return this
       */
@@ -83,6 +471,149 @@ class Matrix{
       */
     ~Matrix();
 
+    /**
+      * @brief Sets number of columns in one panel of blocked LU factorization.
+      * Blocked LU factorization is used for determinant, rank and inverse of dense
+      * matrices.
+      * @throw MatrixException
+      * @param size block size
+      * @sa LU
+      */
+    static void setBlockSize(size_t size);
+    /**
+      * @brief Turns exact rank and determinant of dense integer matrices on or off.
+      * @param on true for exact computation
+      * @sa Modular
+      */
+    static void setExact(bool on);
+    /**
+      * @brief Turns Strassen-Winograd multiplication of big dense matrices on or off.
+      * It is faster, but rounding errors are slightly bigger than with the classic
+      * algorithm.
+      * @param on true for Strassen-Winograd multiplication
+      * @sa Kernels::strassen
+      */
+    static void setStrassen(bool on);
+
+    /**
+      * @brief Returns number of rows.
+      * @return number of rows
+      */
+    size_t getRows() const;
+    /**
+      * @brief Returns number of columns.
+      * @return number of columns
+      */
+    size_t getCols() const;
+    /**
+      * @brief Tells whether dense elements are stored in single precision.
+      * @return true for single precision and false for double precision
+      */
+    bool isSinglePrecision() const;
+    /**
+      * @brief Returns copy of this matrix in single precision.
+      * Dense matrices in single precision need half of the memory and they are
+      * multiplied and factored in <b>float</b>. Results of operations are in single
+      * precision only if all operands are. Sparse storage keeps double precision.
+      * @return matrix in single precision
+      */
+    Matrix toSingle() const;
+    /**
+      * @brief Returns copy of this matrix in double precision.
+      * @return matrix in double precision
+      */
+    Matrix toDouble() const;
+    /**
+      * @brief Tells whether elements are in GF(2).
+      * @return true for matrices over GF(2)
+      */
+    bool isBinaryField() const;
+    /**
+      * @brief Returns copy of this integer matrix over GF(2).
+      * Elements are reduced modulo 2 and stored in BitMatrix, 64 of them in one word.
+      * Operations of matrices over GF(2) give matrices over GF(2), operands over GF(2)
+      * cannot be mixed with operands over reals. Views are not made, MERGE and SPLIT
+      * copy bits. DOUBLE and FLOAT convert the matrix back to reals.
+      * @throw MatrixException if an element is not an integer
+      * @return matrix over GF(2)
+      * @sa BitMatrix
+      */
+    Matrix toBinary() const;
+
+    /**
+      * @brief Makes dense matrix in array of the caller, elements are not copied.
+      * Matrix keeps dense storage whatever its ratio of zeros or structure is. Array
+      * must exist as long as the matrix and its copies. Results of operations are new
+      * matrices. In-place changes (<b>+=</b>, <b>-=</b>, <b>*=</b> by a matrix or by a
+      * number including zero, <b>=</b> of a number) of a matrix whose storage is not
+      * shared with a copy write to the array, also when the other operand has another
+      * precision: elements are rounded to the precision of the array. Change of a
+      * matrix whose storage is shared first copies the storage, the array stays
+      * unchanged. Assignment of another matrix replaces the storage.
+      * @throw MatrixException if a dimension is zero
+      * @param r rows
+      * @param c columns
+      * @param data r * c elements stored by rows
+      * @return matrix in double precision
+      */
+    static Matrix adopt(size_t r, size_t c, double * data);
+    /**
+      * @brief Makes dense matrix in single precision in array of the caller.
+      * @throw MatrixException if a dimension is zero
+      * @param r rows
+      * @param c columns
+      * @param data r * c elements stored by rows
+      * @return matrix in single precision
+      * @sa adopt(size_t, size_t, double *)
+      */
+    static Matrix adopt(size_t r, size_t c, float * data);
+    /**
+      * @brief Makes sparse matrix in compressed sparse row arrays of the caller.
+      * Matrix is a CompressedRows view, so arrays are not copied until an operation needs
+      * stored elements. Arrays must exist and must not change as long as the matrix and
+      * its copies.
+      * @throw MatrixException if a dimension is zero or arrays are not valid
+      * @param r rows
+      * @param c columns
+      * @param rowPtr r + 1 starts of rows in <i>cols</i> and <i>values</i>
+      * @param cols increasing columns of every row
+      * @param values elements
+      * @return matrix
+      * @sa CompressedRows
+      */
+    static Matrix adopt(size_t r, size_t c, const size_t * rowPtr, const size_t * cols, const double * values);
+    /**
+      * @brief Returns number of non-zero elements.
+      * @return number of non-zero elements
+      */
+    size_t countNonZeros() const;
+    /**
+      * @brief Returns number of bytes of elements owned by storage of this matrix.
+      * Views and arrays of the caller are not counted, storage shared by copies of the
+      * matrix is counted in every copy.
+      * @return bytes
+      */
+    size_t getMemory() const;
+    /**
+      * @brief Returns name of storage of this matrix.
+      * @return dense, float, sparse, view, gf2, diagonal, upper, lower, symmetric or band
+      */
+    const char * getStorageName() const;
+    /**
+      * @brief Copies elements to array of the caller.
+      * @param[out] out r * c elements stored by rows
+      */
+    void copyTo(double * out) const;
+    /**
+      * @brief Copies non-zero elements to compressed sparse row arrays of the caller.
+      * Arrays must be large enough for countNonZeros elements, columns of every row are
+      * increasing.
+      * @param[out] rowPtr r + 1 starts of rows
+      * @param[out] cols columns
+      * @param[out] values elements
+      */
+    void copyTo(size_t * rowPtr, size_t * cols, double * values) const;
+
     /**
       * @brief Makes matrix which is sum of this matrix and other matrix.
       * @throw MatrixException
@@ -99,6 +630,11 @@ class Matrix{
     Matrix operator -(const Matrix & other) const;
     /**
       * @brief Makes matrix which is multiplication of this matrix and other matrix.
+      * Two dense matrices of the same precision are multiplied by blocked Kernels::gemm,
+      * or by Kernels::strassen if it is turned on and all dimensions exceed
+      * Kernels::STRASSEN_CROSSOVER.
+      * Square matrices up to FIXED_SIZE are multiplied by FixedMatrix. Band matrices read
+      * only elements in the band.
       * @throw MatrixException
       * @param other other
       * @return Matrix multiplication
@@ -111,6 +647,38 @@ class Matrix{
       * @return Matrix
       */
     friend Matrix operator *(double x, const Matrix & m);
+    /**
+      * @brief Makes sum of this matrix and transposed matrix without transposing it.
+      * @throw MatrixException
+      * @param other transposed matrix
+      * @return Matrix sum
+      */
+    Matrix operator +(const Transposed & other) const;
+    /**
+      * @brief Makes difference of this matrix and transposed matrix without transposing
+      * it.
+      * @throw MatrixException
+      * @param other transposed matrix
+      * @return Matrix difference
+      */
+    Matrix operator -(const Transposed & other) const;
+    /**
+      * @brief Makes product of this matrix and transposed matrix without transposing it.
+      * Two dense matrices of the same precision are multiplied by Kernels::gemmNT.
+      * @throw MatrixException
+      * @param other transposed matrix
+      * @return Matrix multiplication
+      */
+    Matrix operator *(const Transposed & other) const;
+    /**
+      * @brief Makes product of transposed matrix and matrix without transposing it.
+      * Two dense matrices of the same precision are multiplied by Kernels::gemmTN.
+      * @throw MatrixException
+      * @param a transposed matrix
+      * @param b matrix
+      * @return Matrix multiplication
+      */
+    friend Matrix operator *(const Transposed & a, const Matrix & b);
 
     /**
       * @brief Sets every element on main diagonal to x.
@@ -121,6 +689,9 @@ class Matrix{
 
     /**
       * @brief Adds to this matrix another matrix.
+      * Elements are updated in place in one pass, only stored elements of a sparse
+      * <i>other</i> are visited. Storage is copied only if it is shared. Dense storage
+      * stays dense. Single precision matrix plus double precision matrix becomes double.
       * @throw MatrixException
       * @param other other matrix
       * @return this
@@ -128,6 +699,7 @@ class Matrix{
     Matrix & operator +=(const Matrix & other);
     /**
       * @brief Substracts from this matrix another matrix.
+      * Elements are updated in place like in operator +=.
       * @throw MatrixException
       * @param other other matrix
       * @return this
@@ -135,6 +707,9 @@ class Matrix{
     Matrix & operator -=(const Matrix & other);
     /**
       * @brief Multiplies this matrix by another matrix.
+      * Dense matrix multiplied by dense square matrix of the same precision is updated
+      * in place through a workspace which is reused by next calls, other cases make new
+      * matrix.
       * @throw MatrixException
       * @param other other matrix
       * @return this
@@ -142,6 +717,7 @@ class Matrix{
     Matrix & operator *=(const Matrix & other);
     /**
       * @brief Scalar multiplication of matrix <i>m</i>.
+      * Elements are multiplied in place.
       * @param m matrix
       * @param x scalar
       * @return this
@@ -151,7 +727,8 @@ class Matrix{
     /**
       * @brief Makes matrix which is concatenation of this matrix and other matrix.
       * Matrices must have the same number of rows. Number of rows of the new matrix is
-      * the sum of the numbers of columns of original matrices. 
+      * the sum of the numbers of columns of original matrices. Result is a
+      * ConcatenatedMatrix view, elements are not copied.
       * @throw MatrixException
       * @param other other matrix
       * @return merged matrix
@@ -160,7 +737,8 @@ class Matrix{
     /**
       * @brief Makes matrix from this matrix.
       * New matrix has dimensions newR x newC and the top left element of the new matrix
-      * is in the <i>posR</i>-th row and <i>posC</i>-th column.
+      * is in the <i>posR</i>-th row and <i>posC</i>-th column. Result is a SubMatrix view,
+      * elements are not copied.
       * @throw MatrixException
       * @param newR number of rows of new matrix
       * @param newC number of columns of new matrix
@@ -178,7 +756,10 @@ class Matrix{
     Matrix gem(gemStates printDetails = gemStates::NO_DETAILS) const;
     /**
       * @brief Returns rank of this matrix.
-      * Rank can be obtained as number of non-zero rows after the GEM.
+      * Rank can be obtained as number of non-zero rows after the GEM. Dense matrices
+      * are factored by blocked LU first and GEM is needed only when a zero pivot is found.
+      * Sparse matrices are factored by sparse LU which counts pivots. Rank of dense
+      * integer matrices is computed exactly by elimination modulo primes.
       * @return rank
       */
     unsigned int rank() const;
@@ -186,26 +767,105 @@ class Matrix{
     /**
       * @brief Returns transposed matrix.
       * Transposed matrix is formed by turning rows of original matrix to colums and vice
-      * versa.
+      * versa. Dense matrices are transposed by cache-oblivious Kernels::transpose, sparse
+      * matrices in O(nnz) by SparseMatrix::transpose.
       * @return transposed matrix
       */
     Matrix transpose() const;
+    /**
+      * @brief Returns transposed view of this matrix.
+      * View costs no memory, it can be used as an operand of <b>+</b>, <b>-</b> and
+      * <b>*</b>.
+      * @return view
+      */
+    Transposed transposed() const;
+    /**
+      * @brief Reorders rows and columns of square matrix by the same permutation.
+      * Reverse Cuthill-McKee ordering reduces bandwidth, so the result often gets
+      * BandMatrix storage, nested dissection reduces fill-in of sparse LU. Ordering of
+      * sparse matrix costs O(nnz log n).
+      * @throw MatrixException
+      * @param[out] perm <i>i</i>-th row and column of the result are <i>perm[i]</i>-th
+      * row and column of this matrix
+      * @param method ordering method
+      * @return reordered matrix
+      * @sa Ordering, permute
+      */
+    Matrix reorder(std::vector<size_t> & perm, orderings method = orderings::RCM) const;
+    /**
+      * @brief Permutes rows and columns of square matrix by the same permutation.
+      * Only stored elements of sparse matrix are visited.
+      * @throw MatrixException
+      * @param perm <i>i</i>-th row and column of the result are <i>perm[i]</i>-th row
+      * and column of this matrix
+      * @return permuted matrix
+      */
+    Matrix permute(const std::vector<size_t> & perm) const;
     /**
       * @brief Returns inverse of this matrix.
-      * Inversion can be computed by merging original matrix and identity matrix,
-      * performing reduced GEM and then splitting matrix. If inverse does not exist then
-      * exception is thrown. 
+      * Matrix is factored by blocked LU factorization (dense) or by sparse LU
+      * factorization (sparse) and then every column of identity matrix is solved. If inverse does not exist then exception is
+      * thrown.
       * @throw MatrixException
       */
     Matrix inverse() const;
     /**
       * @brief Returns determinant of this matrix.
-      * Determinant is calculated by GEM.
+      * Determinant is calculated by blocked LU factorization for dense matrices and by
+      * sparse LU factorization for sparse matrices. Determinant of dense integer matrices
+      * is computed exactly by elimination modulo primes if its Hadamard bound has at most
+      * Modular::MAX_BITS bits.
       * @throw MatrixException
       * @return determinant
       * @sa Gem
       */
     double determinant() const;
+    /**
+      * @brief Returns inverses of many matrices.
+      * Square matrices up to FIXED_BATCH_SIZE without special structure are grouped by
+      * dimension and inverted together by FixedBatch, other matrices by inverse.
+      * @throw MatrixException if a matrix is not square or is singular
+      * @param matrices matrices
+      * @return inverses in the same order
+      */
+    static std::vector<Matrix> inverseBatch(const std::vector<Matrix> & matrices);
+    /**
+      * @brief Returns determinants of many matrices.
+      * Square matrices up to FIXED_BATCH_SIZE without special structure are grouped by
+      * dimension and computed together by FixedBatch, other matrices by determinant.
+      * @throw MatrixException if a matrix is not square
+      * @param matrices matrices
+      * @return determinants in the same order
+      */
+    static std::vector<double> determinantBatch(const std::vector<Matrix> & matrices);
+    /**
+      * @brief Solves system of linear equations AX = B where A is this matrix.
+      * Every column of <i>b</i> is one right-hand side. Matrix is factored only once and
+      * the factorization is kept, so next systems with the same matrix need only forward
+      * and back substitution.
+      * @throw MatrixException
+      * @param b right-hand sides
+      * @return solution X
+      * @sa factorize
+      */
+    Matrix solve(const Matrix & b) const;
+    /**
+      * @brief Solves system of linear equations AX = B by an iterative method.
+      * Every column of <i>b</i> is solved separately starting from zero vector. Only
+      * matrix-vector products are needed, so each iteration costs O(nnz).
+      * @throw MatrixException
+      * @param b right-hand sides
+      * @param method Krylov subspace method
+      * @param precond preconditioner
+      * @param tolerance required residual relative to the right-hand side
+      * @param maxIterations maximum number of iterations for one column
+      * @param[out] iterations the largest number of iterations of one column
+      * @param[out] residual the largest relative residual of one column
+      * @return solution X
+      * @sa IterativeSolver
+      */
+    Matrix solve(const Matrix & b, krylovMethods method, preconditioners precond, double tolerance,
+                 size_t maxIterations, size_t & iterations, double & residual) const;
 
     /**
       * @brief Prints matrix.
@@ -3,64 +3,98 @@
 MatrixType::MatrixType(size_t r, size_t c) : r(r), c(c){
 }
 //---------------------------------------------------------------------------------------
+size_t MatrixType::getRows() const{
+  return r;
+}
+//---------------------------------------------------------------------------------------
+size_t MatrixType::getCols() const{
+  return c;
+}
+//---------------------------------------------------------------------------------------
 double MatrixType::getRatioOfZeros() const{
-  double count = 0;
+  size_t count = 0;
+  forEachNonZero([&](size_t, size_t, double){ ++count; });
+  return (r * c - count) / (double) (r * c);
+}
+//---------------------------------------------------------------------------------------
+void MatrixType::forEachNonZero(const std::function<void(size_t, size_t, double)> & visit) const{
   for(size_t i = 0; i < r; ++i)
-    for(size_t j = 0; j < c; ++j)
-      if(getValue(i, j) == 0)
-        ++count;
-  return count / (double) (r * c);
+    forEachNonZeroInRow(i, [&](size_t j, double x){ visit(i, j, x); });
+}
+//---------------------------------------------------------------------------------------
+void MatrixType::forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const{
+  for(size_t j = 0; j < c; ++j){
+    double x = getValue(i, j);
+    if(x != 0)
+      visit(j, x);
+  }
+}
+//---------------------------------------------------------------------------------------
+void MatrixType::setRowValues(size_t i, const std::vector<std::pair<size_t, double>> & elements){
+  for(const auto & x : elements)
+    setValue(i, x.first, x.second);
 }
 //---------------------------------------------------------------------------------------
 void MatrixType::swapRows(size_t i, size_t j){
   if(i >= r || j >= r)
     return;
-  for(size_t k = 0; k < c; ++k){
-    double tmp = getValue(i, k);
-    setValue(i, k, getValue(j, k));
-    setValue(j, k, tmp);
-  }
+  //rows are read first, storage may change while elements are set
+  std::vector<std::pair<size_t, double>> a, b;
+  forEachNonZeroInRow(i, [&](size_t k, double x){ a.emplace_back(k, x); });
+  forEachNonZeroInRow(j, [&](size_t k, double x){ b.emplace_back(k, x); });
+  for(const auto & x : a)
+    setValue(i, x.first, 0);
+  for(const auto & x : b)
+    setValue(j, x.first, 0);
+  setRowValues(i, b);
+  setRowValues(j, a);
 }
 //---------------------------------------------------------------------------------------
 void MatrixType::multiplyRow(size_t i, double x){
   if(i >= r || x == 0)
     return;
-  for(size_t k = 0; k < c; ++k)
-    setValue(i, k, getValue(i, k) * x);
+  std::vector<std::pair<size_t, double>> row;
+  forEachNonZeroInRow(i, [&](size_t k, double y){ row.emplace_back(k, y * x); });
+  setRowValues(i, row);
 }
 //---------------------------------------------------------------------------------------
 void MatrixType::addRow(size_t i, size_t j, double x){
   if(i >= r || j >= r || x == 0)
     return;
-  for(size_t k = 0; k < c; ++k)
-    setValue(i, k, getValue(i, k) + getValue(j, k) * x);
+  std::vector<std::pair<size_t, double>> row;
+  forEachNonZeroInRow(j, [&](size_t k, double y){ row.emplace_back(k, y * x); });
+  for(auto & y : row)
+    y.second = getValue(i, y.first) + y.second;
+  setRowValues(i, row);
 }
 //---------------------------------------------------------------------------------------
 unsigned int MatrixType::countZeroRows() const{
-  //set count as maximum
-  unsigned int count = r;
+  //count rows which have a non-zero element
+  unsigned int count = 0;
   for(size_t i = 0; i < r; ++i){
-    //assume this is zero row
     bool zero = true;
-    for(size_t j = 0; j < c; ++j)
-      //if non-zero element is found then this is not a zero row
-      if(getValue(i, j) != 0){
-        zero = false;
-        break;
-      }
-    //if this is zero row then decrement number of non-zero rows 
-    if(zero) 
-      --count;
+    forEachNonZeroInRow(i, [&](size_t, double){ zero = false; });
+    if(!zero)
+      ++count;
   }
   return count;
 }
 //---------------------------------------------------------------------------------------
 std::ostream & operator <<(std::ostream & os, const MatrixType & x){
   for(size_t i = 0; i < x.r; ++i){
-    for(size_t j = 0; j < x.c; ++j){
-      double val = x.getValue(i, j);
-      os << std::setw(6) << ((val == -0) ? 0 : val) << ((j != x.c - 1) ? " " : "");
-    }
+    //zeros before every non-zero element and at the end of row are printed directly
+    size_t next = 0;
+    auto print = [&](size_t j, double val){
+      os << std::setw(6) << val << ((j != x.c - 1) ? " " : "");
+    };
+    x.forEachNonZeroInRow(i, [&](size_t j, double val){
+      for(; next < j; ++next)
+        print(next, 0.0);
+      print(j, val);
+      next = j + 1;
+    });
+    for(; next < x.c; ++next)
+      print(next, 0.0);
     os << std::endl;
   }
   return os;
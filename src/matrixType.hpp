@@ -4,6 +4,8 @@
 #include <iostream>
 #include <iomanip>
 #include <map>
+#include <vector>
+#include <functional>
 #include "matrixException.hpp"
 
 /**
@@ -26,12 +28,27 @@ class MatrixType{
       */           
     virtual ~MatrixType() = default;
     
+    /**
+      * @brief Returns number of rows.
+      * @return rows
+      */
+    size_t getRows() const;
+    /**
+      * @brief Returns number of columns.
+      * @return columns
+      */
+    size_t getCols() const;
     /**
       * @brief Computes ratio of elements equal to zero.
       * Ratio is computed as count of all zero elements divided by count of all elements.
       * @return ratio
       */
-    double getRatioOfZeros() const;
+    virtual double getRatioOfZeros() const;
+    /**
+      * @brief Returns number of bytes of elements owned by this storage.
+      * @return bytes
+      */
+    virtual size_t getMemory() const = 0;
     /**
       * @brief Returns value of the element in <i>i</i>-th row and <i>j</i>-th column.
       * @param i row
@@ -46,10 +63,34 @@ class MatrixType{
       * @param x value of inserted element
       */
     virtual void setValue(size_t i, size_t j, double x) = 0;
+    /**
+      * @brief Calls <i>visit</i> for every non-zero element.
+      * Elements are visited by rows and then by columns. Default implementation visits
+      * rows by forEachNonZeroInRow.
+      * @param visit function of row, column and value
+      */
+    virtual void forEachNonZero(const std::function<void(size_t, size_t, double)> & visit) const;
+    /**
+      * @brief Calls <i>visit</i> for every non-zero element of <i>i</i>-th row.
+      * Elements are visited by columns. Default implementation reads every element by
+      * getValue, storages which know their non-zero elements visit only them.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    /**
+      * @brief Sets elements of <i>i</i>-th row.
+      * Other elements of the row are not changed. SparseMatrix inserts elements ordered
+      * by columns in constant time each.
+      * @param i row
+      * @param elements columns and values
+      */
+    virtual void setRowValues(size_t i, const std::vector<std::pair<size_t, double>> & elements);
 
     /**
       * @brief Swaps <i>i</i>-th and <i>j</i>-th row.
-      * If non-existing row is selected then nothing happens.
+      * Only non-zero elements of both rows are moved. If non-existing row is selected
+      * then nothing happens.
       * @param i row
       * @param j row
       * @sa Gem
@@ -57,8 +98,8 @@ class MatrixType{
     void swapRows(size_t i, size_t j);
     /**
       * @brief Multiplies <i>i</i>-th row by <i>x</i>.
-      * Every element in the <i>i</i>-th row is multiplied by <i>x</i>. If <i>x</i> is
-      * equal to zero or non-existing row is selected then nothing happens.
+      * Every non-zero element in the <i>i</i>-th row is multiplied by <i>x</i>. If
+      * <i>x</i> is equal to zero or non-existing row is selected then nothing happens.
       * @param i row
       * @param x multiplier
       * @sa Gem
@@ -66,7 +107,8 @@ class MatrixType{
     void multiplyRow(size_t i, double x);
     /**
       * @brief Adds <i>j</i>-th row multiplied by x to <i>i</i>-th row.
-      * If <i>x</i> is equal to zero or non-existing row is selected then nothing happens.
+      * Only columns where <i>j</i>-th row is non-zero are changed. If <i>x</i> is equal
+      * to zero or non-existing row is selected then nothing happens.
       * @param i row
       * @param j row
       * @param x multiplier
@@ -83,6 +125,7 @@ class MatrixType{
     /**
       * @brief Prints matrix.
       * Elements are printed with the width 6. There is a newline after the last row.
+      * Only non-zero elements are read, zeros between them are printed directly.
       * @param os output stream
       * @param x matrix
       * @return os output stream
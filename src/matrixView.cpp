@@ -0,0 +1,106 @@
+#include "matrixView.hpp"
+#include <algorithm>
+
+using namespace std;
+
+const size_t MatrixView::MAX_DEPTH = 8;
+
+MatrixView::MatrixView(size_t r, size_t c, size_t depth) : MatrixType(r, c), depth(depth){
+}
+//---------------------------------------------------------------------------------------
+void MatrixView::setValue(size_t i, size_t j, double x){
+  throw MatrixException("View cannot be changed!");
+}
+//---------------------------------------------------------------------------------------
+size_t MatrixView::getMemory() const{
+  return 0;
+}
+//---------------------------------------------------------------------------------------
+size_t MatrixView::getDepth(const MatrixType & m){
+  const MatrixView * view = dynamic_cast<const MatrixView *>(&m);
+  return view ? view->depth : 0;
+}
+//---------------------------------------------------------------------------------------
+SubMatrix::SubMatrix(const shared_ptr<const MatrixType> & source, size_t r, size_t c, size_t posR, size_t posC)
+  : MatrixView(r, c, getDepth(*source) + 1), source(source), posR(posR), posC(posC){
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<MatrixType> SubMatrix::make(const shared_ptr<const MatrixType> & source, size_t r, size_t c,
+                                       size_t posR, size_t posC){
+  const SubMatrix * sub = dynamic_cast<const SubMatrix *>(source.get());
+  if(sub)
+    return make(sub->source, r, c, sub->posR + posR, sub->posC + posC);
+  const ConcatenatedMatrix * cat = dynamic_cast<const ConcatenatedMatrix *>(source.get());
+  if(cat){
+    size_t cols = cat->getLeft()->getCols();
+    if(posC + c <= cols)
+      return make(cat->getLeft(), r, c, posR, posC);
+    if(posC >= cols)
+      return make(cat->getRight(), r, c, posR, posC - cols);
+  }
+  return make_shared<SubMatrix>(source, r, c, posR, posC);
+}
+//---------------------------------------------------------------------------------------
+double SubMatrix::getValue(size_t i, size_t j) const{
+  return source->getValue(posR + i, posC + j);
+}
+//---------------------------------------------------------------------------------------
+void SubMatrix::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  source->forEachNonZeroInRow(posR + i, [&](size_t j, double x){
+    if(j >= posC && j < posC + c)
+      visit(j - posC, x);
+  });
+}
+//---------------------------------------------------------------------------------------
+ConcatenatedMatrix::ConcatenatedMatrix(const shared_ptr<const MatrixType> & left, const shared_ptr<const MatrixType> & right)
+  : MatrixView(left->getRows(), left->getCols() + right->getCols(), max(getDepth(*left), getDepth(*right)) + 1),
+    left(left), right(right){
+}
+//---------------------------------------------------------------------------------------
+double ConcatenatedMatrix::getValue(size_t i, size_t j) const{
+  size_t cols = left->getCols();
+  return j < cols ? left->getValue(i, j) : right->getValue(i, j - cols);
+}
+//---------------------------------------------------------------------------------------
+void ConcatenatedMatrix::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  size_t cols = left->getCols();
+  left->forEachNonZeroInRow(i, visit);
+  right->forEachNonZeroInRow(i, [&](size_t j, double x){
+    visit(cols + j, x);
+  });
+}
+//---------------------------------------------------------------------------------------
+const shared_ptr<const MatrixType> & ConcatenatedMatrix::getLeft() const{
+  return left;
+}
+//---------------------------------------------------------------------------------------
+const shared_ptr<const MatrixType> & ConcatenatedMatrix::getRight() const{
+  return right;
+}
+//---------------------------------------------------------------------------------------
+CompressedRows::CompressedRows(size_t r, size_t c, const size_t * rowPtr, const size_t * cols, const double * values)
+  : MatrixView(r, c, 1), rowPtr(rowPtr), cols(cols), values(values){
+  for(size_t i = 0; i < r; ++i){
+    if(rowPtr[i] > rowPtr[i + 1])
+      throw MatrixException("Starts of rows must not decrease!");
+    for(size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k)
+      if(cols[k] >= c || (k > rowPtr[i] && cols[k] <= cols[k - 1]))
+        throw MatrixException("Columns of row must be increasing and inside the matrix!");
+  }
+}
+//---------------------------------------------------------------------------------------
+double CompressedRows::getValue(size_t i, size_t j) const{
+  const size_t * begin = cols + rowPtr[i], * end = cols + rowPtr[i + 1];
+  const size_t * p = lower_bound(begin, end, j);
+  return p != end && *p == j ? values[p - cols] : 0;
+}
+//---------------------------------------------------------------------------------------
+void CompressedRows::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  for(size_t k = rowPtr[i]; k < rowPtr[i + 1]; ++k)
+    if(values[k] != 0)
+      visit(cols[k], values[k]);
+}
+//---------------------------------------------------------------------------------------
+double CompressedRows::getRatioOfZeros() const{
+  return (r * c - (rowPtr[r] - rowPtr[0])) / (double) (r * c);
+}
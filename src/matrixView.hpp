@@ -0,0 +1,173 @@
+#ifndef MATRIXVIEW_HPP
+#define MATRIXVIEW_HPP
+
+#include <memory>
+#include "matrixType.hpp"
+
+/**
+  * @brief Base class for matrices which read elements of other matrices.
+  *
+  * View shares storages of original matrices and copies nothing. Stored matrices are
+  * never changed while they are shared, so the view stays valid as long as it holds its
+  * references. View cannot be changed, matrix has to be copied to its own storage first.
+  */
+class MatrixView : public MatrixType{
+  protected:
+    size_t depth; ///< Number of views between this view and stored matrices.
+  public:
+    /**
+      * @brief Maximum depth of views, deeper views are copied.
+      */
+    static const size_t MAX_DEPTH;
+
+    /**
+      * @brief Constructs view with dimensions r x c.
+      * @param r number of rows
+      * @param c number of columns
+      * @param depth depth of view
+      */
+    MatrixView(size_t r, size_t c, size_t depth);
+
+    /**
+      * @brief Views cannot be changed.
+      * @throw MatrixException
+      */
+    virtual void setValue(size_t i, size_t j, double x);
+    /**
+      * @brief Views own no elements.
+      * @return 0
+      */
+    virtual size_t getMemory() const;
+    /**
+      * @brief Returns number of views between matrix and stored matrices.
+      * @param m matrix
+      * @return depth of view or 0 for stored matrix
+      */
+    static size_t getDepth(const MatrixType & m);
+};
+
+/**
+  * @brief Rectangular window of another matrix.
+  */
+class SubMatrix : public MatrixView{
+  private:
+    std::shared_ptr<const MatrixType> source; ///< Original matrix.
+    size_t posR, ///< Row of original matrix where the window starts.
+           posC; ///< Column of original matrix where the window starts.
+  public:
+    /**
+      * @brief Constructs window with dimensions r x c.
+      * Window must lie inside the original matrix.
+      * @param source original matrix
+      * @param r number of rows
+      * @param c number of columns
+      * @param posR row where the top left element is located
+      * @param posC column where the top left element is located
+      */
+    SubMatrix(const std::shared_ptr<const MatrixType> & source, size_t r, size_t c, size_t posR, size_t posC);
+    /**
+      * @brief Makes window of matrix.
+      * Window of a window refers directly to the original matrix and window which lies
+      * inside one part of a ConcatenatedMatrix refers to that part, so views do not nest.
+      * @param source original matrix
+      * @param r number of rows
+      * @param c number of columns
+      * @param posR row where the top left element is located
+      * @param posC column where the top left element is located
+      * @return window
+      */
+    static std::shared_ptr<MatrixType> make(const std::shared_ptr<const MatrixType> & source, size_t r, size_t c,
+                                            size_t posR, size_t posC);
+
+    virtual double getValue(size_t i, size_t j) const;
+    /**
+      * @brief Calls <i>visit</i> for every non-zero element of <i>i</i>-th row.
+      * Row of the original matrix is visited and elements outside of the window are
+      * skipped.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+};
+
+/**
+  * @brief Horizontal concatenation of two matrices with the same number of rows.
+  */
+class ConcatenatedMatrix : public MatrixView{
+  private:
+    std::shared_ptr<const MatrixType> left, ///< Left part.
+                                      right; ///< Right part.
+  public:
+    /**
+      * @brief Constructs concatenation of two matrices.
+      * @param left left part
+      * @param right right part
+      */
+    ConcatenatedMatrix(const std::shared_ptr<const MatrixType> & left, const std::shared_ptr<const MatrixType> & right);
+
+    virtual double getValue(size_t i, size_t j) const;
+    /**
+      * @brief Calls <i>visit</i> for every non-zero element of <i>i</i>-th row.
+      * Row of the left part is visited first, then row of the right part.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    /**
+      * @brief Returns left part.
+      * @return left part
+      */
+    const std::shared_ptr<const MatrixType> & getLeft() const;
+    /**
+      * @brief Returns right part.
+      * @return right part
+      */
+    const std::shared_ptr<const MatrixType> & getRight() const;
+};
+
+/**
+  * @brief Sparse matrix in compressed sparse row arrays of the caller.
+  *
+  * Elements of <i>i</i>-th row are <i>values[rowPtr[i]]</i> up to
+  * <i>values[rowPtr[i + 1] - 1]</i> in columns <i>cols[rowPtr[i]]</i> and so on, columns
+  * of every row are increasing. Arrays are not copied, they must exist and must not be
+  * changed as long as the view is used.
+  */
+class CompressedRows : public MatrixView{
+  private:
+    const size_t * rowPtr, ///< Start of every row in <i>cols</i> and <i>values</i> and the end.
+                 * cols; ///< Column of every element.
+    const double * values; ///< Value of every element.
+  public:
+    /**
+      * @brief Constructs view of arrays.
+      * @param r number of rows
+      * @param c number of columns
+      * @param rowPtr r + 1 starts of rows
+      * @param cols columns
+      * @param values values
+      * @throw MatrixException if starts of rows decrease or a column is out of range
+      */
+    CompressedRows(size_t r, size_t c, const size_t * rowPtr, const size_t * cols, const double * values);
+
+    /**
+      * @brief Returns element found by binary search in its row.
+      * @param i row
+      * @param j column
+      * @return element
+      */
+    virtual double getValue(size_t i, size_t j) const;
+    /**
+      * @brief Calls <i>visit</i> for every stored non-zero element of <i>i</i>-th row.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    /**
+      * @brief Computes ratio of zeros from the number of stored elements.
+      * @return ratio
+      */
+    virtual double getRatioOfZeros() const;
+};
+
+#endif /* MATRIXVIEW_HPP */
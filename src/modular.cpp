@@ -0,0 +1,166 @@
+#include "modular.hpp"
+#include <cmath>
+#include <algorithm>
+
+using namespace std;
+
+const double Modular::MAX_BITS = 2048;
+
+Modular::Modular(const MatrixType & matrix) : r(matrix.getRows()), c(matrix.getCols()), data(r * c){
+  for(size_t i = 0; i < r; ++i){
+    double sum = 0;
+    for(size_t j = 0; j < c; ++j){
+      data[i * c + j] = matrix.getValue(i, j);
+      sum += data[i * c + j] * data[i * c + j];
+    }
+    if(sum == 0)
+      zeroRow = true;
+    else
+      bits += log2(sum) / 2;
+  }
+}
+//---------------------------------------------------------------------------------------
+bool Modular::isIntegral(const MatrixType & matrix){
+  for(size_t i = 0; i < matrix.getRows(); ++i)
+    for(size_t j = 0; j < matrix.getCols(); ++j){
+      double val = matrix.getValue(i, j);
+      if(val != floor(val) || fabs(val) >= 9007199254740992.0)
+        return false;
+    }
+  return true;
+}
+//---------------------------------------------------------------------------------------
+const vector<double> & Modular::getPrimes(){
+  static const vector<double> primes = []{
+    vector<double> tmp;
+    size_t count = (size_t) (MAX_BITS / 25) + 4;
+    for(long long candidate = (1 << 26) - 1; tmp.size() < count; candidate -= 2){
+      bool prime = true;
+      for(long long d = 3; d * d <= candidate; d += 2)
+        if(candidate % d == 0){
+          prime = false;
+          break;
+        }
+      if(prime)
+        tmp.push_back(candidate);
+    }
+    return tmp;
+  }();
+  return primes;
+}
+//---------------------------------------------------------------------------------------
+double Modular::mulMod(double a, double b, double p){
+  double x = a * b;
+  x -= floor(x / p) * p;
+  return x < 0 ? x + p : (x >= p ? x - p : x);
+}
+//---------------------------------------------------------------------------------------
+double Modular::invMod(double a, double p){
+  long long t = 0, newT = 1, rem = p, newRem = a;
+  while(newRem != 0){
+    long long q = rem / newRem;
+    t -= q * newT;
+    swap(t, newT);
+    rem -= q * newRem;
+    swap(rem, newRem);
+  }
+  return t < 0 ? t + p : t;
+}
+//---------------------------------------------------------------------------------------
+unsigned int Modular::eliminate(double p, double & det) const{
+  vector<double> a(data.size());
+  for(size_t i = 0; i < a.size(); ++i){
+    double x = fmod(data[i], p);
+    a[i] = x < 0 ? x + p : x;
+  }
+  double inv = 1 / p;
+  size_t k = 0;
+  det = 1;
+  for(size_t l = 0; l < c && k < r; ++l){
+    size_t pivot = k;
+    while(pivot < r && a[pivot * c + l] == 0)
+      ++pivot;
+    if(pivot == r){
+      det = 0;
+      continue;
+    }
+    if(pivot != k){
+      swap_ranges(a.begin() + pivot * c, a.begin() + (pivot + 1) * c, a.begin() + k * c);
+      det = (det == 0) ? 0 : p - det;
+    }
+    double * rk = &a[k * c];
+    det = mulMod(det, rk[l], p);
+    double scale = invMod(rk[l], p);
+    for(size_t j = l; j < c; ++j)
+      rk[j] = mulMod(rk[j], scale, p);
+    for(size_t i = k + 1; i < r; ++i){
+      double * ri = &a[i * c];
+      if(ri[l] == 0)
+        continue;
+      //a + f * b is smaller than 2^53, so it is exact
+      double f = p - ri[l];
+      for(size_t j = l; j < c; ++j){
+        double x = ri[j] + f * rk[j];
+        x -= floor(x * inv) * p;
+        ri[j] = x < 0 ? x + p : (x >= p ? x - p : x);
+      }
+    }
+    ++k;
+  }
+  return k;
+}
+//---------------------------------------------------------------------------------------
+double Modular::getDeterminantBits() const{
+  return bits;
+}
+//---------------------------------------------------------------------------------------
+unsigned int Modular::rank() const{
+  const vector<double> & primes = getPrimes();
+  unsigned int best = 0, last = 0;
+  double det;
+  for(size_t k = 0; k < primes.size(); ++k){
+    unsigned int tmp = eliminate(primes[k], det);
+    best = max(best, tmp);
+    if(best == min(r, c) || (k > 0 && tmp == last))
+      break;
+    last = tmp;
+  }
+  return best;
+}
+//---------------------------------------------------------------------------------------
+double Modular::determinant() const{
+  if(zeroRow)
+    return 0;
+  const vector<double> & primes = getPrimes();
+  vector<double> digits;
+  double covered = 0;
+  size_t stable = 0;
+  for(size_t k = 0; k < primes.size(); ++k){
+    double p = primes[k], t;
+    eliminate(p, t);
+    //next mixed radix digit (Garner's algorithm)
+    for(size_t j = 0; j < k; ++j){
+      t -= digits[j];
+      if(t < 0)
+        t += p;
+      t = mulMod(t, invMod(fmod(primes[j], p), p), p);
+    }
+    digits.push_back(t);
+    covered += log2(p);
+    //zero digit (or p - 1 for negative numbers) does not change the result
+    stable = (k > 0 && (t == 0 || t == p - 1)) ? stable + 1 : 0;
+    if(covered > bits + 1 || stable == 2)
+      break;
+  }
+  //number is negative if it is greater than half of the product of primes
+  bool negative = false;
+  for(size_t i = digits.size(); i-- > 0;)
+    if(digits[i] != (primes[i] - 1) / 2){
+      negative = digits[i] > (primes[i] - 1) / 2;
+      break;
+    }
+  long double val = 0;
+  for(size_t i = digits.size(); i-- > 0;)
+    val = val * primes[i] + (negative ? primes[i] - 1 - digits[i] : digits[i]);
+  return negative ? -(double) (val + 1) : (double) val;
+}
@@ -0,0 +1,94 @@
+#ifndef MODULAR_HPP
+#define MODULAR_HPP
+
+#include <vector>
+#include "matrixType.hpp"
+
+/**
+  * @brief Exact rank and determinant of integer matrices.
+  *
+  * Matrix is eliminated modulo several primes smaller than 2<sup>26</sup>. Residues are
+  * stored as <b>double</b>, so a + f * b is exact and rows are updated by loops which
+  * compiler can vectorize. Rank over rationals is the largest rank modulo the primes.
+  * Determinant is reconstructed from residues by Chinese remainder theorem in mixed
+  * radix form (Garner's algorithm), which needs no big integers. Reconstruction stops
+  * when the product of primes exceeds twice the Hadamard bound or earlier, when two
+  * more primes do not change the result.
+  */
+class Modular{
+  private:
+    size_t r, ///< Number of rows.
+           c; ///< Number of columns.
+    std::vector<double> data; ///< Elements stored row by row.
+    double bits = 0; ///< Base 2 logarithm of the Hadamard bound of determinant.
+    bool zeroRow = false; ///< Whether there is a zero row.
+
+    /**
+      * @brief Returns primes used for elimination.
+      * Primes are the largest primes smaller than 2<sup>26</sup> in descending order.
+      * There are enough of them to reconstruct determinant with MAX_BITS bits.
+      * @return primes
+      */
+    static const std::vector<double> & getPrimes();
+    /**
+      * @brief Returns <i>a</i> * <i>b</i> modulo <i>p</i>.
+      * @param a first factor
+      * @param b second factor
+      * @param p prime
+      * @return product
+      */
+    static double mulMod(double a, double b, double p);
+    /**
+      * @brief Returns inverse of <i>a</i> modulo <i>p</i>.
+      * @param a non-zero residue
+      * @param p prime
+      * @return inverse
+      */
+    static double invMod(double a, double p);
+    /**
+      * @brief Performs Gaussian elimination modulo <i>p</i>.
+      * @param p prime
+      * @param[out] det determinant modulo <i>p</i>
+      * @return rank modulo <i>p</i>
+      */
+    unsigned int eliminate(double p, double & det) const;
+  public:
+    /**
+      * @brief Maximum Hadamard bound (in bits) for exact determinant.
+      * Determinants of matrices with greater bound do not fit into <b>double</b> anyway.
+      */
+    static const double MAX_BITS;
+
+    /**
+      * @brief Tells whether every element of matrix is an integer.
+      * Elements must be smaller than 2<sup>53</sup> in absolute value.
+      * @param matrix matrix
+      * @return true if matrix is integral otherwise false
+      */
+    static bool isIntegral(const MatrixType & matrix);
+    /**
+      * @brief Prepares integer matrix.
+      * @param matrix integral matrix
+      * @sa isIntegral
+      */
+    Modular(const MatrixType & matrix);
+    /**
+      * @brief Returns base 2 logarithm of the Hadamard bound of determinant.
+      * @return bound in bits
+      */
+    double getDeterminantBits() const;
+    /**
+      * @brief Computes rank.
+      * Rank is the largest rank modulo primes, computation stops when two primes agree.
+      * @return rank
+      */
+    unsigned int rank() const;
+    /**
+      * @brief Computes determinant.
+      * Matrix must be square.
+      * @return determinant
+      */
+    double determinant() const;
+};
+
+#endif /* MODULAR_HPP */
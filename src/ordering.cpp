@@ -0,0 +1,131 @@
+#include "ordering.hpp"
+#include <algorithm>
+
+using namespace std;
+
+const size_t Ordering::LEAF_SIZE = 16;
+
+Ordering::Ordering(const MatrixType & m) : adjacency(m.getRows()), part(m.getRows(), 0), mark(m.getRows(), 0){
+  m.forEachNonZero([this](size_t i, size_t j, double){
+    if(i != j){
+      adjacency[i].push_back(j);
+      adjacency[j].push_back(i);
+    }
+  });
+  //symmetric elements make every edge twice
+  for(auto & x : adjacency){
+    sort(x.begin(), x.end());
+    x.erase(unique(x.begin(), x.end()), x.end());
+  }
+}
+//---------------------------------------------------------------------------------------
+void Ordering::levels(size_t start, size_t id){
+  ++search;
+  order.assign(1, start);
+  bounds.clear();
+  mark[start] = search;
+  for(size_t begin = 0; begin < order.size();){
+    bounds.push_back(begin);
+    size_t end = order.size();
+    for(size_t k = begin; k < end; ++k)
+      for(size_t u : adjacency[order[k]])
+        if(part[u] == id && mark[u] != search){
+          mark[u] = search;
+          order.push_back(u);
+        }
+    begin = end;
+  }
+  bounds.push_back(order.size());
+}
+//---------------------------------------------------------------------------------------
+size_t Ordering::peripheral(size_t start, size_t id){
+  levels(start, id);
+  size_t depth = bounds.size();
+  while(true){
+    size_t best = order[bounds[depth - 2]];
+    for(size_t k = bounds[depth - 2]; k < order.size(); ++k)
+      if(adjacency[order[k]].size() < adjacency[best].size())
+        best = order[k];
+    levels(best, id);
+    if(bounds.size() <= depth)
+      return start;
+    start = best;
+    depth = bounds.size();
+  }
+}
+//---------------------------------------------------------------------------------------
+vector<size_t> Ordering::reverseCuthillMcKee(){
+  size_t n = adjacency.size();
+  vector<size_t> out;
+  vector<bool> placed(n, false);
+  vector<size_t> next;
+  out.reserve(n);
+  for(size_t s = 0; s < n; ++s){
+    if(placed[s])
+      continue;
+    //rows of one component are placed by breadth-first search from its periphery
+    size_t head = out.size();
+    size_t root = peripheral(s, 0);
+    out.push_back(root);
+    placed[root] = true;
+    while(head < out.size()){
+      next.clear();
+      for(size_t u : adjacency[out[head++]])
+        if(!placed[u]){
+          placed[u] = true;
+          next.push_back(u);
+        }
+      stable_sort(next.begin(), next.end(), [this](size_t a, size_t b){
+        return adjacency[a].size() < adjacency[b].size();
+      });
+      out.insert(out.end(), next.begin(), next.end());
+    }
+  }
+  reverse(out.begin(), out.end());
+  return out;
+}
+//---------------------------------------------------------------------------------------
+vector<size_t> Ordering::nestedDissection(){
+  vector<size_t> nodes(adjacency.size()), out;
+  for(size_t i = 0; i < nodes.size(); ++i)
+    nodes[i] = i;
+  out.reserve(nodes.size());
+  dissect(nodes, out);
+  return out;
+}
+//---------------------------------------------------------------------------------------
+void Ordering::dissect(const vector<size_t> & nodes, vector<size_t> & out){
+  if(nodes.size() <= LEAF_SIZE){
+    out.insert(out.end(), nodes.begin(), nodes.end());
+    return;
+  }
+  size_t id = ++parts;
+  for(size_t v : nodes)
+    part[v] = id;
+  levels(peripheral(nodes[0], id), id);
+  if(order.size() < nodes.size()){
+    //components of disconnected part are ordered separately
+    vector<size_t> component(order), rest;
+    for(size_t v : nodes)
+      if(mark[v] != search)
+        rest.push_back(v);
+    dissect(component, out);
+    dissect(rest, out);
+    return;
+  }
+  size_t depth = bounds.size() - 1;
+  if(depth < 3){
+    out.insert(out.end(), nodes.begin(), nodes.end());
+    return;
+  }
+  //separator is the level with the middle row, so both halves have at most half of rows
+  size_t mid = 1;
+  while(mid + 2 < depth && bounds[mid + 1] <= order.size() / 2)
+    ++mid;
+  vector<size_t> first(order.begin(), order.begin() + bounds[mid]),
+                 separator(order.begin() + bounds[mid], order.begin() + bounds[mid + 1]),
+                 second(order.begin() + bounds[mid + 1], order.end());
+  dissect(first, out);
+  dissect(second, out);
+  out.insert(out.end(), separator.begin(), separator.end());
+}
@@ -0,0 +1,86 @@
+#ifndef ORDERING_HPP
+#define ORDERING_HPP
+
+#include <vector>
+#include "matrixType.hpp"
+
+/**
+  * @brief Methods of symmetric reordering of square matrices.
+  */
+enum class orderings{
+  RCM, ///< Reverse Cuthill-McKee, reduces bandwidth.
+  NESTED_DISSECTION ///< Nested dissection, reduces fill-in of elimination.
+};
+
+/**
+  * @brief Fill reducing orderings of rows and columns of square matrix.
+  *
+  * Ordering works on the graph of the matrix where rows i and j are neighbours if
+  * element (i, j) or (j, i) is non-zero. The graph is built by visiting non-zero
+  * elements, so for SparseMatrix both orderings cost O(nnz log n). Result is permutation
+  * <i>perm</i> where <i>i</i>-th row and column of the reordered matrix are
+  * <i>perm[i]</i>-th row and column of the original matrix.
+  */
+class Ordering{
+  private:
+    std::vector<std::vector<size_t>> adjacency; ///< Sorted neighbours of every row.
+    std::vector<size_t> part, ///< Part of nested dissection which row belongs to.
+                        mark, ///< Number of the last breadth-first search which visited row.
+                        order, ///< Rows in the order of the last breadth-first search.
+                        bounds; ///< Starts of levels of the last search in <i>order</i> and its end.
+    size_t search = 0, ///< Number of breadth-first searches so far.
+           parts = 0; ///< Number of parts of nested dissection so far.
+
+    /**
+      * @brief Finds level structure of rows reachable from <i>start</i> in one part.
+      * Result is stored in <i>order</i> and <i>bounds</i>, visited rows are marked by
+      * the number of this search.
+      * @param start first row
+      * @param id part which rows must belong to
+      */
+    void levels(size_t start, size_t id);
+    /**
+      * @brief Finds pseudo-peripheral row by the algorithm of George and Liu.
+      * Search is restarted from the row of the last level with the smallest degree while
+      * the number of levels grows. Level structure of the last search is left in
+      * <i>order</i> and <i>bounds</i>, it need not belong to the returned row.
+      * @param start any row of the component
+      * @param id part which rows must belong to
+      * @return row with large eccentricity
+      */
+    size_t peripheral(size_t start, size_t id);
+    /**
+      * @brief Orders rows of part recursively, separators are ordered last.
+      * The middle level of the level structure from a pseudo-peripheral row separates
+      * the part into two halves.
+      * @param nodes rows of part
+      * @param[out] out ordered rows
+      */
+    void dissect(const std::vector<size_t> & nodes, std::vector<size_t> & out);
+  public:
+    /**
+      * @brief Parts with at most so many rows are not dissected.
+      */
+    static const size_t LEAF_SIZE;
+
+    /**
+      * @brief Builds graph of square matrix.
+      * @param m matrix
+      */
+    Ordering(const MatrixType & m);
+    /**
+      * @brief Finds reverse Cuthill-McKee ordering.
+      * Every connected component is ordered by breadth-first search from a
+      * pseudo-peripheral row, neighbours are visited from the smallest degree, and the
+      * whole order is reversed.
+      * @return permutation
+      */
+    std::vector<size_t> reverseCuthillMcKee();
+    /**
+      * @brief Finds nested dissection ordering.
+      * @return permutation
+      */
+    std::vector<size_t> nestedDissection();
+};
+
+#endif /* ORDERING_HPP */
@@ -0,0 +1,257 @@
+#include "processPool.hpp"
+#include "kernels.hpp"
+#include "matrixException.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+const size_t ProcessPool::MIN_WORK = (size_t) 1 << 24;
+const char * const ProcessPool::WORKER_ARG = "--matrix-worker";
+const int ProcessPool::WORKER_FD = 3;
+
+namespace{
+  /**
+    * @brief Reads exactly <i>size</i> bytes.
+    * @return true if successful otherwise false
+    */
+  bool readAll(int fd, void * data, size_t size){
+    char * p = static_cast<char *>(data);
+    while(size > 0){
+      ssize_t got = read(fd, p, size);
+      if(got < 0 && errno == EINTR)
+        continue;
+      if(got <= 0)
+        return false;
+      p += got;
+      size -= got;
+    }
+    return true;
+  }
+
+  /**
+    * @brief Writes exactly <i>size</i> bytes, closed peer does not raise SIGPIPE.
+    * @return true if successful otherwise false
+    */
+  bool writeAll(int fd, const void * data, size_t size){
+    const char * p = static_cast<const char *>(data);
+    while(size > 0){
+      ssize_t sent = send(fd, p, size, MSG_NOSIGNAL);
+      if(sent < 0 && errno == EINTR)
+        continue;
+      if(sent <= 0)
+        return false;
+      p += sent;
+      size -= sent;
+    }
+    return true;
+  }
+}
+
+ProcessPool::~ProcessPool(){
+  stop();
+}
+//---------------------------------------------------------------------------------------
+ProcessPool & ProcessPool::getInstance(){
+  static ProcessPool pool;
+  return pool;
+}
+//---------------------------------------------------------------------------------------
+void ProcessPool::start(size_t count){
+  lock_guard<mutex> lock(mtx);
+  stop();
+  for(size_t i = 0; i < count; ++i){
+    int fds[2];
+    if(socketpair(AF_UNIX, SOCK_STREAM, 0, fds) < 0){
+      stop();
+      throw MatrixException("Worker cannot be started!");
+    }
+    //worker is a new image of this program, nothing is done between fork and exec which
+    //could wait for a lock held by another thread of the coordinator
+    long maxFd = sysconf(_SC_OPEN_MAX);
+    char * const args[] = {const_cast<char *>("hruskraj"), const_cast<char *>(WORKER_ARG), NULL};
+    pid_t pid = fork();
+    if(pid < 0){
+      close(fds[0]);
+      close(fds[1]);
+      stop();
+      throw MatrixException("Worker cannot be started!");
+    }
+    if(pid == 0){
+      //worker keeps only its socket, so listening sockets, connections of clients and
+      //sockets of other workers are closed when their owners close them
+      if(dup2(fds[1], WORKER_FD) < 0)
+        _exit(127);
+      for(long fd = WORKER_FD + 1; fd < maxFd; ++fd)
+        close(fd);
+      execv("/proc/self/exe", args);
+      _exit(127);
+    }
+    close(fds[1]);
+    workers.push_back(pid);
+    sockets.push_back(fds[0]);
+    //worker which could not be executed closes the socket without greeting
+    char status = 0;
+    if(!readAll(fds[0], &status, 1) || !status){
+      stop();
+      throw MatrixException("Worker cannot be started!");
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+void ProcessPool::runWorker(int argc, char * argv[]){
+  if(argc != 2 || strcmp(argv[1], WORKER_ARG) != 0)
+    return;
+  char status = 1;
+  if(writeAll(WORKER_FD, &status, 1))
+    work(WORKER_FD);
+  _exit(1);
+}
+//---------------------------------------------------------------------------------------
+void ProcessPool::stop(){
+  Task task = Task();
+  task.op = operations::EXIT;
+  for(int fd : sockets){
+    writeAll(fd, &task, sizeof(task));
+    close(fd);
+  }
+  for(pid_t pid : workers)
+    while(waitpid(pid, NULL, 0) < 0 && errno == EINTR);
+  workers.clear();
+  sockets.clear();
+}
+//---------------------------------------------------------------------------------------
+size_t ProcessPool::getSize(){
+  lock_guard<mutex> lock(mtx);
+  return workers.size();
+}
+//---------------------------------------------------------------------------------------
+void ProcessPool::work(int fd){
+  Task task;
+  while(readAll(fd, &task, sizeof(task)) && task.op != operations::EXIT){
+    char status = task.single ? compute<float>(task) : compute<double>(task);
+    if(!writeAll(fd, &status, 1))
+      break;
+  }
+  close(fd);
+  _exit(0);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+bool ProcessPool::compute(const Task & task){
+  int fd = shm_open(task.segment, O_RDWR, 0);
+  if(fd < 0)
+    return false;
+  size_t m = task.m, n = task.n, k = task.k, size = (m * k + k * n + m * n) * sizeof(T);
+  void * data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(data == MAP_FAILED)
+    return false;
+  const T * a = static_cast<T *>(data), * b = a + m * k;
+  T * c = static_cast<T *>(data) + m * k + k * n;
+  size_t rows = task.end - task.begin;
+  if(task.op == operations::STRASSEN)
+    Kernels::strassen<T>(rows, n, k, a + task.begin * k, k, b, n, c + task.begin * n, n);
+  else
+    Kernels::gemm<T>(rows, n, k, task.alpha, a + task.begin * k, k, b, n, c + task.begin * n, n);
+  munmap(data, size);
+  return true;
+}
+//---------------------------------------------------------------------------------------
+bool ProcessPool::run(Task & task){
+  size_t count = min(workers.size(), (size_t) task.m), sent = 0;
+  bool ok = true;
+  for(size_t i = 0; i < count; ++i){
+    task.begin = task.m * i / count;
+    task.end = task.m * (i + 1) / count;
+    if(!writeAll(sockets[i], &task, sizeof(task))){
+      ok = false;
+      break;
+    }
+    ++sent;
+  }
+  for(size_t i = 0; i < sent; ++i){
+    char status = 0;
+    if(!readAll(sockets[i], &status, 1) || !status)
+      ok = false;
+  }
+  //broken worker cannot be trusted with the next task
+  if(!ok)
+    stop();
+  return ok;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+bool ProcessPool::distribute(operations op, size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                             const T * b, size_t ldb, T * c, size_t ldc){
+  //busy workers are not waited for, the product is computed by the caller
+  unique_lock<mutex> lock(mtx, defer_lock);
+  if(m * n * k < MIN_WORK || !lock.try_lock() || workers.empty())
+    return false;
+  Task task = Task();
+  task.op = op;
+  task.single = sizeof(T) == sizeof(float);
+  snprintf(task.segment, sizeof(task.segment), "/hruskraj-%d-%zu", (int) getpid(), segments++);
+  task.m = m;
+  task.n = n;
+  task.k = k;
+  task.alpha = alpha;
+  size_t size = (m * k + k * n + m * n) * sizeof(T);
+  int fd = shm_open(task.segment, O_RDWR | O_CREAT | O_EXCL, 0600);
+  if(fd < 0)
+    throw MatrixException("Shared memory cannot be created!");
+  void * data = ftruncate(fd, size) == 0 ? mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+  close(fd);
+  if(data == MAP_FAILED){
+    shm_unlink(task.segment);
+    throw MatrixException("Shared memory cannot be created!");
+  }
+  T * sa = static_cast<T *>(data), * sb = sa + m * k, * sc = sb + k * n;
+  for(size_t i = 0; i < m; ++i)
+    copy(a + i * lda, a + i * lda + k, sa + i * k);
+  for(size_t i = 0; i < k; ++i)
+    copy(b + i * ldb, b + i * ldb + n, sb + i * n);
+  //new segment is zero, so C = A * B needs no copy of C
+  if(op == operations::GEMM)
+    for(size_t i = 0; i < m; ++i)
+      copy(c + i * ldc, c + i * ldc + n, sc + i * n);
+  bool ok = run(task);
+  if(ok)
+    for(size_t i = 0; i < m; ++i)
+      copy(sc + i * n, sc + (i + 1) * n, c + i * ldc);
+  munmap(data, size);
+  shm_unlink(task.segment);
+  if(!ok)
+    throw MatrixException("Worker process failed!");
+  return true;
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void ProcessPool::gemm(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                       const T * b, size_t ldb, T * c, size_t ldc){
+  if(!distribute(operations::GEMM, m, n, k, alpha, a, lda, b, ldb, c, ldc))
+    Kernels::gemm<T>(m, n, k, alpha, a, lda, b, ldb, c, ldc);
+}
+//---------------------------------------------------------------------------------------
+template<typename T>
+void ProcessPool::strassen(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                           T * c, size_t ldc){
+  if(!distribute(operations::STRASSEN, m, n, k, (T) 1, a, lda, b, ldb, c, ldc))
+    Kernels::strassen<T>(m, n, k, a, lda, b, ldb, c, ldc);
+}
+//---------------------------------------------------------------------------------------
+template void ProcessPool::gemm<double>(size_t, size_t, size_t, double, const double *, size_t,
+                                        const double *, size_t, double *, size_t);
+template void ProcessPool::gemm<float>(size_t, size_t, size_t, float, const float *, size_t,
+                                       const float *, size_t, float *, size_t);
+template void ProcessPool::strassen<double>(size_t, size_t, size_t, const double *, size_t, const double *, size_t,
+                                            double *, size_t);
+template void ProcessPool::strassen<float>(size_t, size_t, size_t, const float *, size_t, const float *, size_t,
+                                           float *, size_t);
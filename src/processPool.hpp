@@ -0,0 +1,156 @@
+#ifndef PROCESSPOOL_HPP
+#define PROCESSPOOL_HPP
+
+#include <vector>
+#include <mutex>
+#include <cstdint>
+#include <sys/types.h>
+
+/**
+  * @brief Local worker processes which multiply tiles of dense matrices.
+  *
+  * Coordinator (the calculator) forks worker processes and talks to every worker over
+  * its own Unix socket. One operation C += alpha * A * B works like this:
+  * - coordinator creates a POSIX shared memory segment and copies A, B and C into it,
+  * - every worker gets a Task with the name of the segment, dimensions and its band of
+  *   rows of C, maps the segment and computes its rows,
+  * - every worker answers with one status byte, coordinator copies C back and removes
+  *   the segment.
+  *
+  * Workers are started by fork and exec of the same program, so a program which uses the
+  * pool must call runWorker at the beginning of main. Worker inherits only its socket.
+  *
+  * Operands and results never go through the sockets. Task is self-describing, so a
+  * remote node could get the same message together with the segment contents instead of
+  * its name. Only one operation uses the workers at a time.
+  */
+class ProcessPool{
+  private:
+    /**
+      * @brief Operations of workers.
+      */
+    enum class operations : uint32_t{
+      GEMM, ///< Rows of C += alpha * A * B by Kernels::gemm.
+      STRASSEN, ///< Rows of C = A * B by Kernels::strassen, C is zero.
+      EXIT ///< Worker exits.
+    };
+    /**
+      * @brief Message from coordinator to worker.
+      * Segment holds A (m x k), B (k x n) and C (m x n) stored by rows one after
+      * another, elements are <b>float</b> or <b>double</b>.
+      */
+    struct Task{
+      operations op; ///< Operation.
+      uint32_t single; ///< Whether elements are <b>float</b>.
+      char segment[64]; ///< Name of shared memory segment.
+      uint64_t m, ///< Rows of A and C.
+               n, ///< Columns of B and C.
+               k, ///< Columns of A and rows of B.
+               begin, ///< First row of C computed by worker.
+               end; ///< Row after the last row of C computed by worker.
+      double alpha; ///< Multiplier of GEMM.
+    };
+    std::vector<pid_t> workers; ///< Worker processes.
+    std::vector<int> sockets; ///< Coordinator ends of sockets of workers.
+    size_t segments = 0; ///< Number of segments created so far, names are unique.
+    std::mutex mtx; ///< One operation uses workers at a time.
+
+    /// Argument of program which makes it a worker.
+    static const char * const WORKER_ARG;
+    /// Descriptor of socket of worker.
+    static const int WORKER_FD;
+
+    ProcessPool() = default;
+    /**
+      * @brief Main loop of worker process.
+      * Worker reads tasks until EXIT or until the socket is closed, then the process exits.
+      * @param fd worker end of socket
+      */
+    [[noreturn]] static void work(int fd);
+    /**
+      * @brief Computes one task in worker.
+      * @param task task
+      * @return true if successful otherwise false
+      */
+    template<typename T>
+    static bool compute(const Task & task);
+    /**
+      * @brief Sends tasks for bands of rows to all workers and waits for all answers.
+      * @param task task without band of rows
+      * @return true if all workers succeeded otherwise false
+      */
+    bool run(Task & task);
+    /**
+      * @brief Gives product to workers if it is big enough and workers are free.
+      * @param op GEMM or STRASSEN
+      * @return true if product was computed by workers otherwise false
+      * @throw MatrixException if shared memory cannot be created or a worker fails
+      */
+    template<typename T>
+    bool distribute(operations op, size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+                    const T * b, size_t ldb, T * c, size_t ldc);
+    /**
+      * @brief Stops all workers.
+      */
+    void stop();
+  public:
+    /**
+      * @brief Smallest m * n * k of a product given to workers.
+      * Copying operands to shared memory costs O(mk + kn + mn), smaller products are
+      * faster in the calling process.
+      */
+    static const size_t MIN_WORK;
+
+    /**
+      * @brief Stops workers.
+      */
+    ~ProcessPool();
+    ProcessPool(const ProcessPool & other) = delete;
+    ProcessPool & operator =(const ProcessPool & other) = delete;
+
+    /**
+      * @brief Returns pool shared by the whole program.
+      * Pool has no workers until start is called.
+      * @return pool
+      */
+    static ProcessPool & getInstance();
+    /**
+      * @brief Runs worker if program was started as a worker by start.
+      * Worker greets coordinator and serves tasks until it is stopped, then the process
+      * exits. Otherwise nothing is done.
+      * @param argc number of arguments of program
+      * @param argv arguments of program
+      */
+    static void runWorker(int argc, char * argv[]);
+    /**
+      * @brief Stops running workers and starts new ones.
+      * @param count number of workers, 0 stops workers
+      * @throw MatrixException if a worker cannot be started
+      */
+    void start(size_t count);
+    /**
+      * @brief Returns number of workers.
+      * @return number of workers
+      */
+    size_t getSize();
+    /**
+      * @brief Computes C += alpha * A * B, by workers if the product is big enough.
+      * Dimensions and leading dimensions are the same as in Kernels::gemm.
+      * @throw MatrixException if a worker fails
+      */
+    template<typename T>
+    void gemm(size_t m, size_t n, size_t k, T alpha, const T * a, size_t lda,
+              const T * b, size_t ldb, T * c, size_t ldc);
+    /**
+      * @brief Computes C = A * B by Strassen-Winograd algorithm, by workers if the product
+      * is big enough.
+      * Every worker multiplies its band of rows of A by B, so the result differs from
+      * Kernels::strassen of the whole product by rounding.
+      * @throw MatrixException if a worker fails
+      */
+    template<typename T>
+    void strassen(size_t m, size_t n, size_t k, const T * a, size_t lda, const T * b, size_t ldb,
+                  T * c, size_t ldc);
+};
+
+#endif /* PROCESSPOOL_HPP */
@@ -0,0 +1,102 @@
+#include "resultCache.hpp"
+#include <ostream>
+
+using namespace std;
+
+const size_t ResultCache::DEFAULT_CAPACITY = 128;
+const size_t ResultCache::MAX_ELEMENTS = 1 << 24;
+
+ResultCache::ResultCache(size_t capacity) : capacity(capacity){
+}
+//---------------------------------------------------------------------------------------
+ResultCache & ResultCache::getInstance(){
+  static ResultCache cache;
+  return cache;
+}
+//---------------------------------------------------------------------------------------
+bool ResultCache::find(const string & key, Entry & entry){
+  lock_guard<mutex> lock(mtx);
+  const auto & it = index.find(key);
+  if(it == index.end()){
+    ++misses;
+    return false;
+  }
+  ++hits;
+  entries.splice(entries.begin(), entries, it->second);
+  entry = *it->second;
+  return true;
+}
+//---------------------------------------------------------------------------------------
+void ResultCache::insert(const Entry & entry){
+  //dropped matrices are freed after the lock is released
+  list<Entry> dropped;
+  lock_guard<mutex> lock(mtx);
+  if(capacity == 0 || entry.elements > MAX_ELEMENTS || index.count(entry.key))
+    return;
+  entries.push_front(entry);
+  index[entry.key] = entries.begin();
+  elements += entry.elements;
+  while(entries.size() > capacity || elements > MAX_ELEMENTS){
+    index.erase(entries.back().key);
+    elements -= entries.back().elements;
+    dropped.splice(dropped.begin(), entries, prev(entries.end()));
+  }
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> ResultCache::getMatrix(const string & key, const function<Matrix()> & compute){
+  Entry entry;
+  if(find(key, entry))
+    return entry.matrix;
+  shared_ptr<const Matrix> m = make_shared<Matrix>(compute());
+  entry = {key, m, 0, m->getRows() * m->getCols()};
+  insert(entry);
+  return m;
+}
+//---------------------------------------------------------------------------------------
+double ResultCache::getValue(const string & key, const function<double()> & compute){
+  Entry entry;
+  if(find(key, entry))
+    return entry.value;
+  entry = {key, shared_ptr<const Matrix>(), compute(), 0};
+  insert(entry);
+  return entry.value;
+}
+//---------------------------------------------------------------------------------------
+void ResultCache::setCapacity(size_t capacity){
+  list<Entry> dropped;
+  lock_guard<mutex> lock(mtx);
+  this->capacity = capacity;
+  while(entries.size() > capacity){
+    index.erase(entries.back().key);
+    elements -= entries.back().elements;
+    dropped.splice(dropped.begin(), entries, prev(entries.end()));
+  }
+}
+//---------------------------------------------------------------------------------------
+void ResultCache::release(const Matrix * m){
+  list<Entry> dropped;
+  lock_guard<mutex> lock(mtx);
+  for(auto it = entries.begin(); it != entries.end(); ){
+    auto next = std::next(it);
+    if(it->matrix.get() == m){
+      index.erase(it->key);
+      elements -= it->elements;
+      dropped.splice(dropped.begin(), entries, it);
+    }
+    it = next;
+  }
+}
+//---------------------------------------------------------------------------------------
+void ResultCache::clear(){
+  list<Entry> dropped;
+  lock_guard<mutex> lock(mtx);
+  dropped.swap(entries);
+  index.clear();
+  elements = hits = misses = 0;
+}
+//---------------------------------------------------------------------------------------
+void ResultCache::printStats(ostream & os) const{
+  lock_guard<mutex> lock(mtx);
+  os << "Results: " << entries.size() << "/" << capacity << ", hits: " << hits
+     << ", misses: " << misses << endl;
+}
@@ -0,0 +1,110 @@
+#ifndef RESULTCACHE_HPP
+#define RESULTCACHE_HPP
+
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include "matrix.hpp"
+
+/**
+  * @brief Bounded cache of results of pure operations.
+  *
+  * Result is found by a key which starts with the name of operation, followed by versions
+  * of operands and parameters, so keys of different operations never collide and
+  * result never has to be invalidated: a changed variable gets a new version and old results
+  * are just not used any more. Matrices are shared with variables and are never changed,
+  * so a hit costs one lookup and no copy. When the cache is full, the least recently
+  * used result is dropped.
+  */
+class ResultCache{
+  private:
+    /**
+      * @brief Cached result.
+      */
+    struct Entry{
+      std::string key; ///< Key of result.
+      std::shared_ptr<const Matrix> matrix; ///< Matrix result or empty pointer.
+      double value; ///< Scalar result.
+      size_t elements; ///< Number of elements of matrix result.
+    };
+    std::list<Entry> entries; ///< Results from the most recently used.
+    std::unordered_map<std::string, std::list<Entry>::iterator> index; ///< Results by key.
+    size_t capacity, ///< Maximum number of results.
+           elements = 0, ///< Number of elements of all cached matrices.
+           hits = 0, ///< Number of found results.
+           misses = 0; ///< Number of computed results.
+    mutable std::mutex mtx; ///< Guards all members.
+
+    /**
+      * @brief Finds result and marks it as the most recently used.
+      * @param key key
+      * @param[out] entry copy of result
+      * @return true if result was found otherwise false
+      */
+    bool find(const std::string & key, Entry & entry);
+    /**
+      * @brief Adds result and drops the least recently used results over limits.
+      * @param entry result
+      */
+    void insert(const Entry & entry);
+  public:
+    /**
+      * @brief Default maximum number of results.
+      */
+    static const size_t DEFAULT_CAPACITY;
+    /**
+      * @brief Maximum number of elements of all cached matrices.
+      */
+    static const size_t MAX_ELEMENTS;
+
+    /**
+      * @brief Constructs empty cache.
+      * @param capacity maximum number of results, 0 turns cache off
+      */
+    ResultCache(size_t capacity = DEFAULT_CAPACITY);
+    /**
+      * @brief Returns cache shared by the whole program.
+      * @return cache
+      */
+    static ResultCache & getInstance();
+    /**
+      * @brief Returns cached matrix or computes and caches it.
+      * Computation runs outside of the lock, exceptions are not cached.
+      * @param key key
+      * @param compute computation of result
+      * @return result
+      */
+    std::shared_ptr<const Matrix> getMatrix(const std::string & key, const std::function<Matrix()> & compute);
+    /**
+      * @brief Returns cached scalar or computes and caches it.
+      * @param key key
+      * @param compute computation of result
+      * @return result
+      */
+    double getValue(const std::string & key, const std::function<double()> & compute);
+    /**
+      * @brief Sets maximum number of results.
+      * @param capacity maximum number of results, 0 turns cache off
+      */
+    void setCapacity(size_t capacity);
+    /**
+      * @brief Drops results which hold the given matrix.
+      * Stores call it before they free the memory of a matrix in another way.
+      * @param m matrix
+      */
+    void release(const Matrix * m);
+    /**
+      * @brief Drops all results and resets statistics.
+      */
+    void clear();
+    /**
+      * @brief Prints number of results, hits and misses.
+      * @param os output stream
+      */
+    void printStats(std::ostream & os) const;
+};
+
+#endif /* RESULTCACHE_HPP */
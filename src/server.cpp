@@ -0,0 +1,119 @@
+#include "server.hpp"
+#include "handler.hpp"
+#include <iostream>
+#include <thread>
+#include <cstring>
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace std;
+
+SocketBuffer::SocketBuffer(int fd) : fd(fd){
+  setg(in, in, in);
+  setp(out, out + SIZE);
+}
+//---------------------------------------------------------------------------------------
+SocketBuffer::~SocketBuffer(){
+  send();
+  close(fd);
+}
+//---------------------------------------------------------------------------------------
+bool SocketBuffer::send(){
+  const char * data = pbase();
+  size_t size = pptr() - pbase();
+  while(size > 0){
+    ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+    if(sent < 0 && errno == EINTR)
+      continue;
+    if(sent <= 0)
+      return false;
+    data += sent;
+    size -= sent;
+  }
+  setp(out, out + SIZE);
+  return true;
+}
+//---------------------------------------------------------------------------------------
+SocketBuffer::int_type SocketBuffer::underflow(){
+  if(gptr() < egptr())
+    return traits_type::to_int_type(*gptr());
+  //client waits for answer before it sends next command
+  sync();
+  ssize_t size;
+  do
+    size = recv(fd, in, SIZE, 0);
+  while(size < 0 && errno == EINTR);
+  if(size <= 0)
+    return traits_type::eof();
+  setg(in, in, in + size);
+  return traits_type::to_int_type(*gptr());
+}
+//---------------------------------------------------------------------------------------
+SocketBuffer::int_type SocketBuffer::overflow(int_type c){
+  if(!send())
+    return traits_type::eof();
+  if(!traits_type::eq_int_type(c, traits_type::eof())){
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+//---------------------------------------------------------------------------------------
+int SocketBuffer::sync(){
+  return send() ? 0 : -1;
+}
+//---------------------------------------------------------------------------------------
+Server::Server(const string & path) : path(path), shared(make_shared<VariableStore>()){
+}
+//---------------------------------------------------------------------------------------
+void Server::serve(int client, shared_ptr<VariableStore> shared){
+  SocketBuffer buffer(client);
+  iostream stream(&buffer);
+  Handler h(stream, stream, stream, shared);
+  string input;
+  while(getline(stream, input)){
+    if(!h.execute(input))
+      break;
+    stream.flush();
+  }
+}
+//---------------------------------------------------------------------------------------
+bool Server::run(){
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(address.sun_path)){
+    cerr << "Socket path '" << path << "' is too long!" << endl;
+    return false;
+  }
+  strcpy(address.sun_path, path.c_str());
+  //only a stale socket is removed, never a regular file
+  struct stat info;
+  if(lstat(path.c_str(), &info) == 0 && S_ISSOCK(info.st_mode))
+    unlink(path.c_str());
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0 || bind(fd, (sockaddr *) &address, sizeof(address)) < 0 || listen(fd, SOMAXCONN) < 0){
+    cerr << "Cannot listen on '" << path << "': " << strerror(errno) << endl;
+    if(fd >= 0)
+      close(fd);
+    return false;
+  }
+  cerr << "Listening on '" << path << "'" << endl;
+  while(true){
+    int client = accept(fd, NULL, NULL);
+    if(client < 0){
+      if(errno == EINTR || errno == ECONNABORTED)
+        continue;
+      cerr << "Cannot accept client: " << strerror(errno) << endl;
+      break;
+    }
+    thread(&Server::serve, client, shared).detach();
+  }
+  close(fd);
+  return false;
+}
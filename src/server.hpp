@@ -0,0 +1,90 @@
+#ifndef SERVER_HPP
+#define SERVER_HPP
+
+#include <string>
+#include <memory>
+#include <streambuf>
+#include "variableStore.hpp"
+
+/**
+  * @brief Stream buffer which reads from and writes to a socket.
+  * Socket is closed when the buffer is destroyed.
+  */
+class SocketBuffer : public std::streambuf{
+  private:
+    static const size_t SIZE = 4096; ///< Size of input and output buffer.
+    int fd; ///< Socket.
+    char in[SIZE], ///< Input buffer.
+         out[SIZE]; ///< Output buffer.
+
+    /**
+      * @brief Sends content of output buffer.
+      * @return true if successful otherwise false
+      */
+    bool send();
+  protected:
+    /**
+      * @brief Reads more data from socket.
+      * @return next character or end of file
+      */
+    int_type underflow() override;
+    /**
+      * @brief Sends full output buffer and stores <i>c</i>.
+      * @param c character which did not fit into buffer
+      * @return <i>c</i> or end of file on error
+      */
+    int_type overflow(int_type c) override;
+    /**
+      * @brief Sends output buffer.
+      * @return 0 if successful otherwise -1
+      */
+    int sync() override;
+  public:
+    /**
+      * @brief Constructs buffer.
+      * @param fd connected socket
+      */
+    SocketBuffer(int fd);
+    /**
+      * @brief Sends rest of output and closes socket.
+      */
+    ~SocketBuffer();
+    SocketBuffer(const SocketBuffer & other) = delete;
+    SocketBuffer & operator =(const SocketBuffer & other) = delete;
+};
+
+/**
+  * @brief Server which accepts commands from clients on a Unix domain socket.
+  *
+  * Every client is served by its own thread and Handler, with the same command language
+  * as interactive mode. Variables are shared by all clients, variables which names start
+  * with <b>_</b> are private to the client. Long computation of one client does not block
+  * others, because every command works on snapshots of variables.
+  */
+class Server{
+  private:
+    std::string path; ///< Path of socket.
+    std::shared_ptr<VariableStore> shared; ///< Variables shared by all clients.
+
+    /**
+      * @brief Serves one client until it disconnects or types exit.
+      * @param client connected socket
+      * @param shared variables shared by all clients
+      */
+    static void serve(int client, std::shared_ptr<VariableStore> shared);
+  public:
+    /**
+      * @brief Constructs server.
+      * @param path path of socket
+      */
+    Server(const std::string & path);
+    /**
+      * @brief Listens on socket and serves clients.
+      * Existing socket on the path is replaced. Function returns only on error, which is
+      * printed to standard error.
+      * @return false
+      */
+    bool run();
+};
+
+#endif /* SERVER_HPP */
@@ -0,0 +1,224 @@
+#include "sparseLU.hpp"
+#include <set>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+using namespace std;
+
+const double SparseAnalysis::DENSE_ROW = 10;
+const double SparseLU::PIVOT_THRESHOLD = 0.1;
+
+SparseAnalysis::SparseAnalysis(const SparseMatrix & matrix) : r(matrix.getRows()), c(matrix.getCols()){
+  //columns of every row
+  vector<vector<size_t> > rows(r);
+  for(const auto & x : matrix.getData())
+    rows[x.first.first].push_back(x.first.second);
+  size_t dense = max((size_t) 16, (size_t) (DENSE_ROW * sqrt((double) c)));
+  //column intersection graph, columns are adjacent if they share a row
+  vector<set<size_t> > adj(c);
+  for(const auto & row : rows){
+    if(row.size() > dense)
+      continue;
+    for(size_t a = 0; a < row.size(); ++a)
+      for(size_t b = a + 1; b < row.size(); ++b){
+        adj[row[a]].insert(row[b]);
+        adj[row[b]].insert(row[a]);
+      }
+  }
+  //minimum degree, eliminated column makes its neighbours a clique
+  set<pair<size_t, size_t> > queue;
+  for(size_t j = 0; j < c; ++j)
+    queue.insert(make_pair(adj[j].size(), j));
+  order.reserve(c);
+  while(!queue.empty()){
+    size_t v = queue.begin()->second;
+    queue.erase(queue.begin());
+    order.push_back(v);
+    vector<size_t> neighbours(adj[v].begin(), adj[v].end());
+    for(size_t u : neighbours){
+      queue.erase(make_pair(adj[u].size(), u));
+      adj[u].erase(v);
+    }
+    for(size_t a = 0; a < neighbours.size(); ++a)
+      for(size_t b = a + 1; b < neighbours.size(); ++b){
+        adj[neighbours[a]].insert(neighbours[b]);
+        adj[neighbours[b]].insert(neighbours[a]);
+      }
+    for(size_t u : neighbours)
+      queue.insert(make_pair(adj[u].size(), u));
+    set<size_t>().swap(adj[v]);
+  }
+}
+//---------------------------------------------------------------------------------------
+size_t SparseAnalysis::getRows() const{
+  return r;
+}
+//---------------------------------------------------------------------------------------
+size_t SparseAnalysis::getCols() const{
+  return c;
+}
+//---------------------------------------------------------------------------------------
+const vector<size_t> & SparseAnalysis::getOrder() const{
+  return order;
+}
+//---------------------------------------------------------------------------------------
+SparseLU::SparseLU(const SparseMatrix & matrix) : r(matrix.getRows()), c(matrix.getCols()){
+  factor(matrix, SparseAnalysis(matrix));
+}
+//---------------------------------------------------------------------------------------
+SparseLU::SparseLU(const SparseMatrix & matrix, const SparseAnalysis & analysis) : r(matrix.getRows()), c(matrix.getCols()){
+  if(analysis.getRows() != r || analysis.getCols() != c)
+    throw MatrixException("Wrong dimensions!");
+  factor(matrix, analysis);
+}
+//---------------------------------------------------------------------------------------
+void SparseLU::factor(const SparseMatrix & matrix, const SparseAnalysis & analysis){
+  vector<vector<pair<size_t, double> > > cols(c);
+  vector<size_t> rowCount(r, 0);
+  double largest = 0;
+  for(const auto & x : matrix.getData()){
+    cols[x.first.second].push_back(make_pair(x.first.first, x.second));
+    ++rowCount[x.first.first];
+    largest = max(largest, fabs(x.second));
+  }
+  double tolerance = largest * max(r, c) * numeric_limits<double>::epsilon();
+
+  const size_t NONE = numeric_limits<size_t>::max();
+  vector<size_t> step(r, NONE); //pivot of every row
+  vector<double> x(r, 0);
+  vector<char> mark(r, 0);
+  vector<size_t> pattern;
+  vector<pair<size_t, size_t> > stack;
+  for(size_t col : analysis.getOrder()){
+    //pattern of L \ A(:, col) in reverse topological order (depth first search)
+    pattern.clear();
+    for(const auto & e : cols[col]){
+      x[e.first] = e.second;
+      if(mark[e.first])
+        continue;
+      mark[e.first] = 1;
+      stack.push_back(make_pair(e.first, 0));
+      while(!stack.empty()){
+        size_t i = stack.back().first, & next = stack.back().second;
+        if(step[i] != NONE && next < lower[step[i]].size()){
+          size_t t = lower[step[i]][next++].first;
+          if(!mark[t]){
+            mark[t] = 1;
+            stack.push_back(make_pair(t, 0));
+          }
+          continue;
+        }
+        pattern.push_back(i);
+        stack.pop_back();
+      }
+    }
+    //sparse triangular solve
+    for(size_t k = pattern.size(); k-- > 0;){
+      size_t i = pattern[k];
+      if(step[i] == NONE || x[i] == 0)
+        continue;
+      for(const auto & l : lower[step[i]])
+        x[l.first] -= l.second * x[i];
+    }
+    //threshold pivoting
+    double best = 0;
+    for(size_t i : pattern)
+      if(step[i] == NONE)
+        best = max(best, fabs(x[i]));
+    if(best > tolerance){
+      size_t p = NONE;
+      for(size_t i : pattern)
+        if(step[i] == NONE && fabs(x[i]) >= PIVOT_THRESHOLD * best
+           && (p == NONE || rowCount[i] < rowCount[p]
+               || (rowCount[i] == rowCount[p] && fabs(x[i]) > fabs(x[p]))))
+          p = i;
+      size_t k = diag.size();
+      upper.push_back(vector<pair<size_t, double> >());
+      lower.push_back(vector<pair<size_t, double> >());
+      for(size_t i : pattern){
+        if(x[i] == 0 || i == p)
+          continue;
+        if(step[i] != NONE)
+          upper[k].push_back(make_pair(step[i], x[i]));
+        else
+          lower[k].push_back(make_pair(i, x[i] / x[p]));
+      }
+      diag.push_back(x[p]);
+      pivotRow.push_back(p);
+      pivotCol.push_back(col);
+      step[p] = k;
+    }
+    for(size_t i : pattern){
+      x[i] = 0;
+      mark[i] = 0;
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+int SparseLU::sign(const vector<size_t> & p){
+  int s = 1;
+  vector<char> visited(p.size(), 0);
+  for(size_t i = 0; i < p.size(); ++i){
+    if(visited[i])
+      continue;
+    //cycle of length l changes sign l - 1 times
+    for(size_t j = i; !visited[j]; j = p[j]){
+      visited[j] = 1;
+      if(j != i)
+        s = -s;
+    }
+  }
+  return s;
+}
+//---------------------------------------------------------------------------------------
+unsigned int SparseLU::getRank() const{
+  return diag.size();
+}
+//---------------------------------------------------------------------------------------
+bool SparseLU::isSingular() const{
+  return r != c || diag.size() != r;
+}
+//---------------------------------------------------------------------------------------
+double SparseLU::getDeterminant() const{
+  if(isSingular())
+    return 0;
+  double det = sign(pivotRow) * sign(pivotCol);
+  for(double d : diag)
+    det *= d;
+  return det;
+}
+//---------------------------------------------------------------------------------------
+size_t SparseLU::getNonZeros() const{
+  size_t count = diag.size();
+  for(size_t k = 0; k < diag.size(); ++k)
+    count += lower[k].size() + upper[k].size();
+  return count;
+}
+//---------------------------------------------------------------------------------------
+void SparseLU::solve(vector<double> & b, size_t cols) const{
+  size_t n = diag.size();
+  //forward substitution in order of pivots
+  vector<double> z(n * cols);
+  for(size_t k = 0; k < n; ++k){
+    const double * w = &b[pivotRow[k] * cols];
+    copy(w, w + cols, z.begin() + k * cols);
+    for(const auto & l : lower[k]){
+      double * wi = &b[l.first * cols];
+      for(size_t j = 0; j < cols; ++j)
+        wi[j] -= l.second * w[j];
+    }
+  }
+  //column oriented back substitution
+  for(size_t k = n; k-- > 0;){
+    double * zk = &z[k * cols];
+    for(size_t j = 0; j < cols; ++j)
+      zk[j] /= diag[k];
+    for(const auto & u : upper[k]){
+      double * zs = &z[u.first * cols];
+      for(size_t j = 0; j < cols; ++j)
+        zs[j] -= u.second * zk[j];
+    }
+    copy(zk, zk + cols, b.begin() + pivotCol[k] * cols);
+  }
+}
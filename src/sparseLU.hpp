@@ -0,0 +1,119 @@
+#ifndef SPARSELU_HPP
+#define SPARSELU_HPP
+
+#include <vector>
+#include <utility>
+#include "sparseMatrix.hpp"
+#include "factorization.hpp"
+
+/**
+  * @brief Symbolic analysis of a sparse matrix.
+  *
+  * Computes fill-reducing order of columns. Columns are ordered by minimum degree of
+  * the column intersection graph (graph of A<sup>T</sup>A) in the same way as COLAMD.
+  * Rows with too many elements are ignored because they would make the graph complete.
+  * Analysis depends only on positions of non-zero elements, so it can be reused for
+  * every matrix with the same structure.
+  */
+class SparseAnalysis{
+  private:
+    size_t r, ///< Number of rows.
+           c; ///< Number of columns.
+    std::vector<size_t> order; ///< Columns in order of elimination.
+
+    /**
+      * @brief Rows with more than DENSE_ROW * sqrt(c) elements are ignored.
+      */
+    static const double DENSE_ROW;
+  public:
+    /**
+      * @brief Analyses structure of matrix.
+      * @param matrix matrix
+      */
+    SparseAnalysis(const SparseMatrix & matrix);
+    /**
+      * @brief Returns number of rows.
+      * @return rows
+      */
+    size_t getRows() const;
+    /**
+      * @brief Returns number of columns.
+      * @return columns
+      */
+    size_t getCols() const;
+    /**
+      * @brief Returns columns in order of elimination.
+      * @return column order
+      */
+    const std::vector<size_t> & getOrder() const;
+};
+
+/**
+  * @brief Sparse LU factorization.
+  *
+  * Numeric factorization is left-looking (Gilbert-Peierls). Columns are eliminated in
+  * order given by SparseAnalysis and every column is computed by a sparse triangular
+  * solve with already computed columns of L, so the work is proportional to the number
+  * of arithmetic operations. Pivot is chosen by threshold pivoting: from all elements
+  * which are at least PIVOT_THRESHOLD times the largest candidate, the one from the
+  * row with the least elements is taken (Markowitz criterion), which keeps fill low.
+  */
+class SparseLU : public Factorization{
+  private:
+    size_t r, ///< Number of rows.
+           c; ///< Number of columns.
+    std::vector<size_t> pivotRow, ///< Row of <i>k</i>-th pivot.
+                        pivotCol; ///< Column of <i>k</i>-th pivot.
+    std::vector<double> diag; ///< Value of <i>k</i>-th pivot.
+    /// Multipliers of <i>k</i>-th pivot as pairs (row, value).
+    std::vector<std::vector<std::pair<size_t, double> > > lower;
+    /// Column of U above <i>k</i>-th pivot as pairs (pivot, value).
+    std::vector<std::vector<std::pair<size_t, double> > > upper;
+
+    /**
+      * @brief Pivot must be at least this multiple of the largest candidate.
+      */
+    static const double PIVOT_THRESHOLD;
+
+    /**
+      * @brief Computes factors.
+      * @param matrix matrix
+      * @param analysis symbolic analysis of matrix
+      */
+    void factor(const SparseMatrix & matrix, const SparseAnalysis & analysis);
+    /**
+      * @brief Computes sign of permutation.
+      * @param p permutation
+      * @return 1 for even and -1 for odd permutation
+      */
+    static int sign(const std::vector<size_t> & p);
+  public:
+    /**
+      * @brief Analyses and factors matrix.
+      * @param matrix matrix
+      */
+    SparseLU(const SparseMatrix & matrix);
+    /**
+      * @brief Factors matrix using existing symbolic analysis.
+      * @throw MatrixException
+      * @param matrix matrix
+      * @param analysis symbolic analysis of matrix with the same structure
+      */
+    SparseLU(const SparseMatrix & matrix, const SparseAnalysis & analysis);
+    /**
+      * @brief Returns rank.
+      * Rank is the number of pivots found.
+      * @return rank
+      */
+    unsigned int getRank() const;
+    virtual bool isSingular() const;
+    virtual double getDeterminant() const;
+    /**
+      * @brief Returns number of elements stored in factors.
+      * @return number of non-zero elements of L and U
+      */
+    size_t getNonZeros() const;
+    virtual void solve(std::vector<double> & b, size_t cols) const;
+};
+
+#endif /* SPARSELU_HPP */
@@ -1,4 +1,5 @@
 #include "sparseMatrix.hpp"
+#include <vector>
 
 SparseMatrix::SparseMatrix(size_t r, size_t c) : MatrixType(r, c){
 }
@@ -16,6 +17,72 @@ void SparseMatrix::setValue(size_t i, size_t j, double x){
     if(it != data.end())
       data.erase(it);
   }
+  else if(data.empty() || data.rbegin()->first < std::make_pair(i, j))
+    data.emplace_hint(data.end(), std::make_pair(i, j), x);
   else
     data[std::make_pair(i, j)] = x;
 }
+//---------------------------------------------------------------------------------------
+void SparseMatrix::forEachNonZero(const std::function<void(size_t, size_t, double)> & visit) const{
+  for(const auto & x : data)
+    visit(x.first.first, x.first.second, x.second);
+}
+//---------------------------------------------------------------------------------------
+void SparseMatrix::forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const{
+  for(auto it = data.lower_bound(std::make_pair(i, (size_t) 0)); it != data.end() && it->first.first == i; ++it)
+    visit(it->first.second, it->second);
+}
+//---------------------------------------------------------------------------------------
+void SparseMatrix::setRowValues(size_t i, const std::vector<std::pair<size_t, double>> & elements){
+  //every element is inserted right before the element after it
+  auto hint = data.lower_bound(std::make_pair(i + 1, (size_t) 0));
+  for(auto x = elements.rbegin(); x != elements.rend(); ++x){
+    if(x->second == 0){
+      setValue(i, x->first, 0);
+      hint = data.lower_bound(std::make_pair(i, x->first));
+      continue;
+    }
+    hint = data.emplace_hint(hint, std::make_pair(i, x->first), x->second);
+    hint->second = x->second;
+  }
+}
+//---------------------------------------------------------------------------------------
+double SparseMatrix::getRatioOfZeros() const{
+  return (r * c - data.size()) / (double) (r * c);
+}
+//---------------------------------------------------------------------------------------
+size_t SparseMatrix::getMemory() const{
+  return data.size() * (sizeof(std::pair<const std::pair<size_t, size_t>, double>) + 4 * sizeof(void *));
+}
+//---------------------------------------------------------------------------------------
+const std::map<std::pair<size_t, size_t>, double> & SparseMatrix::getData() const{
+  return data;
+}
+//---------------------------------------------------------------------------------------
+void SparseMatrix::scale(double x){
+  for(auto it = data.begin(); it != data.end(); ){
+    it->second *= x;
+    if(it->second == 0)
+      it = data.erase(it);
+    else
+      ++it;
+  }
+}
+//---------------------------------------------------------------------------------------
+SparseMatrix * SparseMatrix::transpose() const{
+  std::vector<size_t> start(c + 1, 0);
+  for(const auto & x : data)
+    ++start[x.first.second + 1];
+  for(size_t j = 0; j < c; ++j)
+    start[j + 1] += start[j];
+  //elements of every column ordered by rows
+  std::vector<std::pair<size_t, double>> columns(data.size());
+  std::vector<size_t> pos(start.begin(), start.end() - 1);
+  for(const auto & x : data)
+    columns[pos[x.first.second]++] = std::make_pair(x.first.first, x.second);
+  SparseMatrix * out = new SparseMatrix(c, r);
+  for(size_t j = 0; j < c; ++j)
+    for(size_t p = start[j]; p < start[j + 1]; ++p)
+      out->data.emplace_hint(out->data.end(), std::make_pair(j, columns[p].first), columns[p].second);
+  return out;
+}
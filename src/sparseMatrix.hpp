@@ -21,7 +21,54 @@ class SparseMatrix : public MatrixType{
     SparseMatrix(size_t r, size_t c);
 
     virtual double getValue(size_t i, size_t j) const;
+    /**
+      * @brief Inserts <i>x</i> in <i>i</i>-th row and <i>j</i>-th column.
+      * Element after the last stored element is appended in constant time, so filling
+      * matrix by rows costs O(nnz).
+      * @param i row
+      * @param j column
+      * @param x value of inserted element
+      */
     virtual void setValue(size_t i, size_t j, double x);
+    virtual void forEachNonZero(const std::function<void(size_t, size_t, double)> & visit) const;
+    /**
+      * @brief Calls <i>visit</i> for every stored element of <i>i</i>-th row.
+      * Row is found in O(log nnz).
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    virtual void setRowValues(size_t i, const std::vector<std::pair<size_t, double>> & elements);
+    /**
+      * @brief Computes ratio of elements equal to zero from the number of stored elements.
+      * @return ratio
+      */
+    virtual double getRatioOfZeros() const;
+    /**
+      * @brief Returns estimated size of map.
+      * Every element is a node of a red-black tree with three pointers and a colour.
+      * @return bytes
+      */
+    virtual size_t getMemory() const;
+    /**
+      * @brief Returns all non-zero elements.
+      * Elements are ordered by rows and then by columns.
+      * @return map from position to value
+      */
+    const std::map<std::pair<size_t, size_t>, double> & getData() const;
+    /**
+      * @brief Multiplies every element by <i>x</i> in place.
+      * Elements which become zero are removed.
+      * @param x multiplier
+      */
+    void scale(double x);
+    /**
+      * @brief Makes transposed matrix in O(nnz + c) time.
+      * Elements are bucketed by columns (counting sort), so they are inserted in the
+      * order of the new map and every insertion takes constant time.
+      * @return new transposed matrix
+      */
+    SparseMatrix * transpose() const;
 };
 
 #endif /* SPARSEMATRIX_HPP */
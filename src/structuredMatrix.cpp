@@ -0,0 +1,310 @@
+#include "structuredMatrix.hpp"
+#include "sparseMatrix.hpp"
+#include <algorithm>
+
+using namespace std;
+
+StructuredMatrix::StructuredMatrix(size_t n, size_t size, size_t lower, size_t upper)
+  : MatrixType(n, n), data(size, 0), lowerBand(lower), upperBand(upper){
+}
+//---------------------------------------------------------------------------------------
+StructuredMatrix * StructuredMatrix::make(structures s, size_t n){
+  switch(s){
+    case structures::DIAGONAL: return new DiagonalMatrix(n);
+    case structures::UPPER: return new TriangularMatrix(n, true);
+    case structures::LOWER: return new TriangularMatrix(n, false);
+    case structures::SYMMETRIC: return new SymmetricMatrix(n);
+    default: throw MatrixException("Unknown structure!");
+  }
+}
+//---------------------------------------------------------------------------------------
+structures StructuredMatrix::detect(const MatrixType & m){
+  size_t n = m.getRows();
+  if(n != m.getCols())
+    return structures::GENERAL;
+  bool upper = true, lower = true, symmetric = true;
+  const SparseMatrix * sparse = dynamic_cast<const SparseMatrix *>(&m);
+  if(sparse){
+    for(const auto & x : sparse->getData()){
+      size_t i = x.first.first, j = x.first.second;
+      upper = upper && i <= j;
+      lower = lower && i >= j;
+      symmetric = symmetric && (i == j || sparse->getValue(j, i) == x.second);
+      if(!upper && !lower && !symmetric)
+        break;
+    }
+  }
+  else{
+    for(size_t i = 0; i < n && (upper || lower || symmetric); ++i)
+      for(size_t j = i + 1; j < n; ++j){
+        double above = m.getValue(i, j), below = m.getValue(j, i);
+        lower = lower && above == 0;
+        upper = upper && below == 0;
+        symmetric = symmetric && above == below;
+      }
+  }
+  if(upper && lower)
+    return structures::DIAGONAL;
+  if(upper)
+    return structures::UPPER;
+  if(lower)
+    return structures::LOWER;
+  return symmetric ? structures::SYMMETRIC : structures::GENERAL;
+}
+//---------------------------------------------------------------------------------------
+size_t StructuredMatrix::getLowerBandwidth() const{
+  return lowerBand;
+}
+//---------------------------------------------------------------------------------------
+size_t StructuredMatrix::getUpperBandwidth() const{
+  return upperBand;
+}
+//---------------------------------------------------------------------------------------
+double StructuredMatrix::getValue(size_t i, size_t j) const{
+  return contains(i, j) ? data[index(i, j)] : 0;
+}
+//---------------------------------------------------------------------------------------
+void StructuredMatrix::setValue(size_t i, size_t j, double x){
+  if(contains(i, j))
+    data[index(i, j)] = x;
+  else if(x != 0)
+    throw MatrixException("Element is outside of the structure!");
+}
+//---------------------------------------------------------------------------------------
+void StructuredMatrix::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  size_t first, last;
+  rowRange(i, first, last);
+  for(size_t j = first; j < last; ++j){
+    double x = data[index(i, j)];
+    if(x != 0)
+      visit(j, x);
+  }
+}
+//---------------------------------------------------------------------------------------
+double StructuredMatrix::getRatioOfZeros() const{
+  size_t count = 0;
+  for(double x : data)
+    if(x != 0)
+      ++count;
+  return (r * c - count) / (double) (r * c);
+}
+//---------------------------------------------------------------------------------------
+size_t StructuredMatrix::getMemory() const{
+  return data.size() * sizeof(double);
+}
+//---------------------------------------------------------------------------------------
+vector<double> & StructuredMatrix::getData(){
+  return data;
+}
+//---------------------------------------------------------------------------------------
+const vector<double> & StructuredMatrix::getData() const{
+  return data;
+}
+//---------------------------------------------------------------------------------------
+void StructuredMatrix::copyFrom(const MatrixType & m){
+  const SparseMatrix * sparse = dynamic_cast<const SparseMatrix *>(&m);
+  if(sparse){
+    sparse->forEachNonZero([&](size_t i, size_t j, double x){
+      if(contains(i, j))
+        data[index(i, j)] = x;
+    });
+    return;
+  }
+  for(size_t i = 0; i < r; ++i){
+    size_t first, last;
+    rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j)
+      data[index(i, j)] = m.getValue(i, j);
+  }
+}
+//---------------------------------------------------------------------------------------
+void StructuredMatrix::copyTo(MatrixType & out) const{
+  bool symmetric = getStructure() == structures::SYMMETRIC;
+  for(size_t i = 0; i < r; ++i){
+    size_t first, last;
+    rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j){
+      double x = data[index(i, j)];
+      if(x == 0)
+        continue;
+      out.setValue(i, j, x);
+      if(symmetric && i != j)
+        out.setValue(j, i, x);
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+DiagonalMatrix::DiagonalMatrix(size_t n) : StructuredMatrix(n, n, 0, 0){
+}
+//---------------------------------------------------------------------------------------
+structures DiagonalMatrix::getStructure() const{
+  return structures::DIAGONAL;
+}
+//---------------------------------------------------------------------------------------
+bool DiagonalMatrix::contains(size_t i, size_t j) const{
+  return i == j;
+}
+//---------------------------------------------------------------------------------------
+size_t DiagonalMatrix::index(size_t i, size_t j) const{
+  return i;
+}
+//---------------------------------------------------------------------------------------
+void DiagonalMatrix::rowRange(size_t i, size_t & first, size_t & last) const{
+  first = i;
+  last = i + 1;
+}
+//---------------------------------------------------------------------------------------
+StructuredMatrix * DiagonalMatrix::makeZero() const{
+  return new DiagonalMatrix(r);
+}
+//---------------------------------------------------------------------------------------
+TriangularMatrix::TriangularMatrix(size_t n, bool upper)
+  : StructuredMatrix(n, n * (n + 1) / 2, upper ? 0 : n - 1, upper ? n - 1 : 0), upper(upper){
+}
+//---------------------------------------------------------------------------------------
+structures TriangularMatrix::getStructure() const{
+  return upper ? structures::UPPER : structures::LOWER;
+}
+//---------------------------------------------------------------------------------------
+bool TriangularMatrix::contains(size_t i, size_t j) const{
+  return upper ? i <= j : i >= j;
+}
+//---------------------------------------------------------------------------------------
+size_t TriangularMatrix::index(size_t i, size_t j) const{
+  if(upper)
+    return i * (2 * c - i + 1) / 2 + j - i;
+  return i * (i + 1) / 2 + j;
+}
+//---------------------------------------------------------------------------------------
+void TriangularMatrix::rowRange(size_t i, size_t & first, size_t & last) const{
+  first = upper ? i : 0;
+  last = upper ? c : i + 1;
+}
+//---------------------------------------------------------------------------------------
+StructuredMatrix * TriangularMatrix::makeZero() const{
+  return new TriangularMatrix(r, upper);
+}
+//---------------------------------------------------------------------------------------
+TriangularMatrix * TriangularMatrix::transpose() const{
+  TriangularMatrix * out = new TriangularMatrix(r, !upper);
+  for(size_t i = 0; i < r; ++i){
+    size_t first, last;
+    rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j)
+      out->data[out->index(j, i)] = data[index(i, j)];
+  }
+  return out;
+}
+//---------------------------------------------------------------------------------------
+SymmetricMatrix::SymmetricMatrix(size_t n) : StructuredMatrix(n, n * (n + 1) / 2, n - 1, n - 1){
+}
+//---------------------------------------------------------------------------------------
+structures SymmetricMatrix::getStructure() const{
+  return structures::SYMMETRIC;
+}
+//---------------------------------------------------------------------------------------
+bool SymmetricMatrix::contains(size_t i, size_t j) const{
+  return true;
+}
+//---------------------------------------------------------------------------------------
+size_t SymmetricMatrix::index(size_t i, size_t j) const{
+  if(i > j)
+    swap(i, j);
+  return i * (2 * c - i + 1) / 2 + j - i;
+}
+//---------------------------------------------------------------------------------------
+void SymmetricMatrix::rowRange(size_t i, size_t & first, size_t & last) const{
+  first = i;
+  last = c;
+}
+//---------------------------------------------------------------------------------------
+StructuredMatrix * SymmetricMatrix::makeZero() const{
+  return new SymmetricMatrix(r);
+}
+//---------------------------------------------------------------------------------------
+void SymmetricMatrix::forEachNonZeroInRow(size_t i, const function<void(size_t, double)> & visit) const{
+  for(size_t j = 0; j < c; ++j){
+    double x = data[index(i, j)];
+    if(x != 0)
+      visit(j, x);
+  }
+}
+//---------------------------------------------------------------------------------------
+double SymmetricMatrix::getRatioOfZeros() const{
+  size_t count = 0;
+  for(size_t i = 0; i < r; ++i)
+    for(size_t j = i; j < c; ++j)
+      if(data[index(i, j)] != 0)
+        count += i == j ? 1 : 2;
+  return (r * c - count) / (double) (r * c);
+}
+//---------------------------------------------------------------------------------------
+BandMatrix::BandMatrix(size_t n, size_t lower, size_t upper)
+  : StructuredMatrix(n, n * (lower + upper + 1), lower, upper){
+}
+//---------------------------------------------------------------------------------------
+bool BandMatrix::findBand(const MatrixType & m, size_t maxWidth, size_t & lower, size_t & upper){
+  size_t n = m.getRows();
+  lower = upper = 0;
+  if(n != m.getCols())
+    return false;
+  const SparseMatrix * sparse = dynamic_cast<const SparseMatrix *>(&m);
+  if(sparse){
+    for(const auto & x : sparse->getData()){
+      size_t i = x.first.first, j = x.first.second;
+      lower = max(lower, i > j ? i - j : 0);
+      upper = max(upper, j > i ? j - i : 0);
+      if(lower + upper + 1 > maxWidth)
+        return false;
+    }
+    return true;
+  }
+  for(size_t i = 0; i < n; ++i){
+    //only elements outside of the band found so far are scanned
+    for(size_t j = 0; j + lower < i; ++j)
+      if(m.getValue(i, j) != 0){
+        lower = i - j;
+        break;
+      }
+    for(size_t j = n - 1; j > i + upper; --j)
+      if(m.getValue(i, j) != 0){
+        upper = j - i;
+        break;
+      }
+    if(lower + upper + 1 > maxWidth)
+      return false;
+  }
+  return true;
+}
+//---------------------------------------------------------------------------------------
+structures BandMatrix::getStructure() const{
+  return structures::BANDED;
+}
+//---------------------------------------------------------------------------------------
+bool BandMatrix::contains(size_t i, size_t j) const{
+  return i <= j + lowerBand && j <= i + upperBand;
+}
+//---------------------------------------------------------------------------------------
+size_t BandMatrix::index(size_t i, size_t j) const{
+  return i * (lowerBand + upperBand + 1) + lowerBand + j - i;
+}
+//---------------------------------------------------------------------------------------
+void BandMatrix::rowRange(size_t i, size_t & first, size_t & last) const{
+  first = i > lowerBand ? i - lowerBand : 0;
+  last = min(c, i + upperBand + 1);
+}
+//---------------------------------------------------------------------------------------
+StructuredMatrix * BandMatrix::makeZero() const{
+  return new BandMatrix(r, lowerBand, upperBand);
+}
+//---------------------------------------------------------------------------------------
+BandMatrix * BandMatrix::transpose() const{
+  BandMatrix * out = new BandMatrix(r, upperBand, lowerBand);
+  for(size_t i = 0; i < r; ++i){
+    size_t first, last;
+    rowRange(i, first, last);
+    for(size_t j = first; j < last; ++j)
+      out->data[out->index(j, i)] = data[index(i, j)];
+  }
+  return out;
+}
@@ -0,0 +1,244 @@
+#ifndef STRUCTUREDMATRIX_HPP
+#define STRUCTUREDMATRIX_HPP
+
+#include <vector>
+#include "matrixType.hpp"
+
+/**
+  * @brief Structures of square matrices which have their own storage.
+  */
+enum class structures{
+  GENERAL, ///< No structure, dense or sparse storage.
+  DIAGONAL, ///< Only elements on the main diagonal can be non-zero.
+  UPPER, ///< Only elements on and above the main diagonal can be non-zero.
+  LOWER, ///< Only elements on and below the main diagonal can be non-zero.
+  SYMMETRIC, ///< Element (i, j) is equal to element (j, i).
+  BANDED ///< Only elements in a narrow band around the main diagonal can be non-zero.
+};
+
+/**
+  * @brief Base class for packed storages of square matrices with a structure.
+  *
+  * Only elements which can be non-zero are stored, in double precision, row by row in
+  * one array. Writing a non-zero element outside of the structure is an error.
+  */
+class StructuredMatrix : public MatrixType{
+  protected:
+    std::vector<double> data; ///< Packed elements.
+    size_t lowerBand, ///< Number of diagonals below the main diagonal which can be non-zero.
+           upperBand; ///< Number of diagonals above the main diagonal which can be non-zero.
+
+    /**
+      * @brief Constructs zero n x n matrix with <i>size</i> packed elements.
+      * @param n number of rows and columns
+      * @param size number of packed elements
+      * @param lower lower bandwidth
+      * @param upper upper bandwidth
+      */
+    StructuredMatrix(size_t n, size_t size, size_t lower, size_t upper);
+  public:
+    /**
+      * @brief Makes zero n x n matrix with given structure.
+      * @param s structure, not GENERAL
+      * @param n number of rows and columns
+      * @return new matrix
+      */
+    static StructuredMatrix * make(structures s, size_t n);
+    /**
+      * @brief Finds the most specific structure of matrix.
+      * Stored elements of SparseMatrix are visited in O(nnz), other matrices are scanned
+      * until the structure is excluded.
+      * @param m matrix
+      * @return DIAGONAL, UPPER, LOWER, SYMMETRIC or GENERAL
+      */
+    static structures detect(const MatrixType & m);
+    /**
+      * @brief Makes zero matrix with the same dimensions, structure and layout.
+      * @return new matrix
+      */
+    virtual StructuredMatrix * makeZero() const = 0;
+
+    /**
+      * @brief Returns structure of matrix.
+      * @return structure
+      */
+    virtual structures getStructure() const = 0;
+    /**
+      * @brief Tells whether element can be non-zero.
+      * @param i row
+      * @param j column
+      * @return true if element is stored
+      */
+    virtual bool contains(size_t i, size_t j) const = 0;
+    /**
+      * @brief Returns position of stored element in packed array.
+      * @param i row
+      * @param j column
+      * @return position
+      */
+    virtual size_t index(size_t i, size_t j) const = 0;
+    /**
+      * @brief Returns number of columns stored in <i>i</i>-th row.
+      * Stored elements of one row are next to each other in packed array.
+      * @param i row
+      * @param[out] first first stored column
+      * @param[out] last column after the last stored column
+      */
+    virtual void rowRange(size_t i, size_t & first, size_t & last) const = 0;
+    /**
+      * @brief Returns number of diagonals below the main diagonal which can be non-zero.
+      * @return lower bandwidth
+      */
+    size_t getLowerBandwidth() const;
+    /**
+      * @brief Returns number of diagonals above the main diagonal which can be non-zero.
+      * @return upper bandwidth
+      */
+    size_t getUpperBandwidth() const;
+
+    virtual double getValue(size_t i, size_t j) const;
+    virtual void setValue(size_t i, size_t j, double x);
+    /**
+      * @brief Calls <i>visit</i> for every non-zero stored element of <i>i</i>-th row.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    virtual double getRatioOfZeros() const;
+    virtual size_t getMemory() const;
+    /**
+      * @brief Returns packed elements.
+      * @return packed elements
+      */
+    std::vector<double> & getData();
+    /**
+      * @brief Returns packed elements.
+      * @return packed elements
+      */
+    const std::vector<double> & getData() const;
+    /**
+      * @brief Copies elements of matrix which lie in the structure.
+      * Only stored elements of SparseMatrix are visited.
+      * @param m source with the same dimensions
+      */
+    void copyFrom(const MatrixType & m);
+    /**
+      * @brief Copies stored elements to other matrix.
+      * Other elements of <i>out</i> are not changed.
+      * @param[out] out destination with the same dimensions
+      */
+    void copyTo(MatrixType & out) const;
+};
+
+/**
+  * @brief Diagonal matrix, n elements are stored.
+  */
+class DiagonalMatrix : public StructuredMatrix{
+  public:
+    /**
+      * @brief Constructs zero n x n matrix.
+      * @param n number of rows and columns
+      */
+    DiagonalMatrix(size_t n);
+
+    virtual structures getStructure() const;
+    virtual bool contains(size_t i, size_t j) const;
+    virtual size_t index(size_t i, size_t j) const;
+    virtual void rowRange(size_t i, size_t & first, size_t & last) const;
+    virtual StructuredMatrix * makeZero() const;
+};
+
+/**
+  * @brief Upper or lower triangular matrix, n(n+1)/2 elements are stored.
+  */
+class TriangularMatrix : public StructuredMatrix{
+  private:
+    bool upper; ///< Upper or lower triangular.
+  public:
+    /**
+      * @brief Constructs zero n x n matrix.
+      * @param n number of rows and columns
+      * @param upper upper or lower triangular
+      */
+    TriangularMatrix(size_t n, bool upper);
+
+    virtual structures getStructure() const;
+    virtual bool contains(size_t i, size_t j) const;
+    virtual size_t index(size_t i, size_t j) const;
+    virtual void rowRange(size_t i, size_t & first, size_t & last) const;
+    virtual StructuredMatrix * makeZero() const;
+    /**
+      * @brief Makes transposed matrix, upper becomes lower and vice versa.
+      * @return new transposed matrix
+      */
+    TriangularMatrix * transpose() const;
+};
+
+/**
+  * @brief Symmetric matrix, elements on and above the main diagonal are stored.
+  * Writing element (i, j) writes element (j, i) too.
+  */
+class SymmetricMatrix : public StructuredMatrix{
+  public:
+    /**
+      * @brief Constructs zero n x n matrix.
+      * @param n number of rows and columns
+      */
+    SymmetricMatrix(size_t n);
+
+    virtual structures getStructure() const;
+    virtual bool contains(size_t i, size_t j) const;
+    virtual size_t index(size_t i, size_t j) const;
+    virtual void rowRange(size_t i, size_t & first, size_t & last) const;
+    virtual StructuredMatrix * makeZero() const;
+    /**
+      * @brief Calls <i>visit</i> for every non-zero element of <i>i</i>-th row.
+      * Elements below the diagonal are read from the stored upper triangle.
+      * @param i row
+      * @param visit function of column and value
+      */
+    virtual void forEachNonZeroInRow(size_t i, const std::function<void(size_t, double)> & visit) const;
+    virtual double getRatioOfZeros() const;
+};
+
+/**
+  * @brief Band matrix, n(lower+upper+1) elements are stored.
+  *
+  * Layout is the compact band storage of LAPACK stored by rows instead of by columns:
+  * every row has lower+upper+1 slots and element (i, j) is in slot lower+j-i of
+  * <i>i</i>-th row. Slots outside of the matrix in the first and last rows are unused.
+  */
+class BandMatrix : public StructuredMatrix{
+  public:
+    /**
+      * @brief Constructs zero n x n matrix.
+      * @param n number of rows and columns
+      * @param lower number of diagonals below the main diagonal
+      * @param upper number of diagonals above the main diagonal
+      */
+    BandMatrix(size_t n, size_t lower, size_t upper);
+    /**
+      * @brief Finds band of square matrix if it is narrow.
+      * Stored elements of SparseMatrix are visited in O(nnz), other matrices are scanned
+      * from both ends of every row until the band is too wide.
+      * @param m matrix
+      * @param maxWidth largest accepted lower+upper+1
+      * @param[out] lower lower bandwidth
+      * @param[out] upper upper bandwidth
+      * @return true if band is not wider than <i>maxWidth</i>
+      */
+    static bool findBand(const MatrixType & m, size_t maxWidth, size_t & lower, size_t & upper);
+
+    virtual structures getStructure() const;
+    virtual bool contains(size_t i, size_t j) const;
+    virtual size_t index(size_t i, size_t j) const;
+    virtual void rowRange(size_t i, size_t & first, size_t & last) const;
+    virtual StructuredMatrix * makeZero() const;
+    /**
+      * @brief Makes transposed matrix, lower and upper bandwidths are swapped.
+      * @return new transposed matrix
+      */
+    BandMatrix * transpose() const;
+};
+
+#endif /* STRUCTUREDMATRIX_HPP */
@@ -0,0 +1,82 @@
+#include "threadPool.hpp"
+#include <memory>
+#include <algorithm>
+
+using namespace std;
+
+namespace{
+  thread_local bool worker = false; ///< Whether this thread is a worker.
+}
+
+ThreadPool::ThreadPool(size_t threads){
+  for(size_t i = 0; i < threads; ++i)
+    workers.push_back(thread(&ThreadPool::work, this));
+}
+//---------------------------------------------------------------------------------------
+ThreadPool::~ThreadPool(){
+  {
+    lock_guard<mutex> lock(mtx);
+    stop = true;
+  }
+  cv.notify_all();
+  for(auto & t : workers)
+    t.join();
+}
+//---------------------------------------------------------------------------------------
+void ThreadPool::work(){
+  worker = true;
+  while(true){
+    function<void()> task;
+    {
+      unique_lock<mutex> lock(mtx);
+      cv.wait(lock, [this]{ return stop || !tasks.empty(); });
+      if(tasks.empty())
+        return;
+      task = move(tasks.front());
+      tasks.pop();
+    }
+    task();
+  }
+}
+//---------------------------------------------------------------------------------------
+ThreadPool & ThreadPool::getInstance(){
+  static ThreadPool pool(max(thread::hardware_concurrency(), 1u));
+  return pool;
+}
+//---------------------------------------------------------------------------------------
+bool ThreadPool::isWorker(){
+  return worker;
+}
+//---------------------------------------------------------------------------------------
+size_t ThreadPool::getSize() const{
+  return workers.size();
+}
+//---------------------------------------------------------------------------------------
+future<void> ThreadPool::submit(const function<void()> & task){
+  auto packaged = make_shared<packaged_task<void()> >(task);
+  future<void> result = packaged->get_future();
+  {
+    lock_guard<mutex> lock(mtx);
+    tasks.push([packaged]{ (*packaged)(); });
+  }
+  cv.notify_one();
+  return result;
+}
+//---------------------------------------------------------------------------------------
+void ThreadPool::parallelFor(size_t n, const function<void(size_t, size_t)> & body){
+  size_t parts = min(getSize(), n);
+  if(parts <= 1 || isWorker()){
+    body(0, n);
+    return;
+  }
+  vector<future<void> > done;
+  size_t chunk = (n + parts - 1) / parts;
+  for(size_t begin = chunk; begin < n; begin += chunk){
+    size_t end = min(n, begin + chunk);
+    done.push_back(submit([&body, begin, end]{ body(begin, end); }));
+  }
+  //the first part is processed by the calling thread
+  body(0, chunk);
+  for(auto & f : done)
+    f.get();
+}
@@ -0,0 +1,76 @@
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+
+/**
+  * @brief Fixed group of worker threads which run submitted tasks.
+  *
+  * One pool shared by the whole program is returned by getInstance. Work which is
+  * started from a worker thread by parallelFor runs in that thread only, so a task in
+  * the pool never waits for other tasks in the pool.
+  */
+class ThreadPool{
+  private:
+    std::vector<std::thread> workers; ///< Worker threads.
+    std::queue<std::function<void()> > tasks; ///< Tasks waiting for a worker.
+    std::mutex mtx; ///< Guards tasks and stop.
+    std::condition_variable cv; ///< Signals new task or stop.
+    bool stop = false; ///< Whether workers should finish.
+
+    /**
+      * @brief Main loop of a worker thread.
+      */
+    void work();
+  public:
+    /**
+      * @brief Starts worker threads.
+      * @param threads number of threads
+      */
+    ThreadPool(size_t threads);
+    /**
+      * @brief Finishes waiting tasks and joins worker threads.
+      */
+    ~ThreadPool();
+    ThreadPool(const ThreadPool & other) = delete;
+    ThreadPool & operator =(const ThreadPool & other) = delete;
+
+    /**
+      * @brief Returns pool shared by the whole program.
+      * Pool has as many threads as there are hardware threads.
+      * @return pool
+      */
+    static ThreadPool & getInstance();
+    /**
+      * @brief Tells whether the calling thread is a worker of some pool.
+      * @return true if called from a worker otherwise false
+      */
+    static bool isWorker();
+    /**
+      * @brief Returns number of worker threads.
+      * @return number of threads
+      */
+    size_t getSize() const;
+    /**
+      * @brief Adds task.
+      * @param task task
+      * @return future which is ready when the task is finished
+      */
+    std::future<void> submit(const std::function<void()> & task);
+    /**
+      * @brief Calls body on parts of range [0, n) in parallel.
+      * Range is split into at most getSize() parts and every part [begin, end) is
+      * processed by one call of body. Function returns when all parts are done.
+      * @param n size of range
+      * @param body function called with begin and end of a part
+      */
+    void parallelFor(size_t n, const std::function<void(size_t, size_t)> & body);
+};
+
+#endif /* THREADPOOL_HPP */
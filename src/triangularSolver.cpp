@@ -0,0 +1,46 @@
+#include "triangularSolver.hpp"
+
+using namespace std;
+
+TriangularSolver::TriangularSolver(const shared_ptr<const StructuredMatrix> & matrix) : matrix(matrix){
+  structures s = matrix->getStructure();
+  if(s != structures::DIAGONAL && s != structures::UPPER && s != structures::LOWER)
+    throw MatrixException("Matrix is not triangular!");
+  for(size_t i = 0; i < matrix->getRows(); ++i)
+    if(matrix->getValue(i, i) == 0)
+      singular = true;
+}
+//---------------------------------------------------------------------------------------
+bool TriangularSolver::isSingular() const{
+  return singular;
+}
+//---------------------------------------------------------------------------------------
+double TriangularSolver::getDeterminant() const{
+  double det = 1;
+  for(size_t i = 0; i < matrix->getRows(); ++i)
+    det *= matrix->getValue(i, i);
+  return det;
+}
+//---------------------------------------------------------------------------------------
+void TriangularSolver::solve(vector<double> & b, size_t cols) const{
+  size_t n = matrix->getRows();
+  const vector<double> & data = matrix->getData();
+  bool upper = matrix->getStructure() == structures::UPPER;
+  for(size_t step = 0; step < n; ++step){
+    //back substitution goes from the last row, forward substitution from the first row
+    size_t i = upper ? n - 1 - step : step, first, last;
+    matrix->rowRange(i, first, last);
+    double * bi = &b[i * cols];
+    for(size_t j = first; j < last; ++j){
+      double x = data[matrix->index(i, j)];
+      if(j == i || x == 0)
+        continue;
+      const double * bj = &b[j * cols];
+      for(size_t k = 0; k < cols; ++k)
+        bi[k] -= x * bj[k];
+    }
+    double pivot = data[matrix->index(i, i)];
+    for(size_t k = 0; k < cols; ++k)
+      bi[k] /= pivot;
+  }
+}
@@ -0,0 +1,33 @@
+#ifndef TRIANGULARSOLVER_HPP
+#define TRIANGULARSOLVER_HPP
+
+#include <memory>
+#include "factorization.hpp"
+#include "structuredMatrix.hpp"
+
+/**
+  * @brief Factorization of diagonal and triangular matrices.
+  *
+  * Such matrices are already factored, so nothing is computed and the storage of the
+  * matrix is shared. Determinant is the product of the diagonal in O(n) and systems are
+  * solved by forward or back substitution in O(n<sup>2</sup>) per right-hand side
+  * (O(n) for diagonal matrices).
+  */
+class TriangularSolver : public Factorization{
+  private:
+    std::shared_ptr<const StructuredMatrix> matrix; ///< Diagonal or triangular matrix.
+    bool singular = false; ///< Some element on the diagonal is zero.
+  public:
+    /**
+      * @brief Constructs factorization of matrix.
+      * @throw MatrixException
+      * @param matrix diagonal or triangular matrix
+      */
+    TriangularSolver(const std::shared_ptr<const StructuredMatrix> & matrix);
+
+    virtual bool isSingular() const;
+    virtual double getDeterminant() const;
+    virtual void solve(std::vector<double> & b, size_t cols) const;
+};
+
+#endif /* TRIANGULARSOLVER_HPP */
@@ -0,0 +1,291 @@
+#include "variableStore.hpp"
+#include "resultCache.hpp"
+#include <vector>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+atomic<size_t> VariableStore::lastVersion(0);
+atomic<size_t> VariableStore::idleTimeout(0);
+atomic<size_t> VariableStore::memoryLimit(0);
+atomic<size_t> VariableStore::memoryUsed(0);
+
+VariableStore::~VariableStore(){
+  {
+    lock_guard<mutex> lock(mtx);
+    stop = true;
+  }
+  cv.notify_all();
+  if(compressor.joinable())
+    compressor.join();
+  for(const auto & x : vars)
+    memoryUsed -= x.second.bytes;
+  if(scratch >= 0)
+    close(scratch);
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::setIdleTimeout(size_t seconds){
+  idleTimeout = seconds;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::startCompressor(){
+  lock_guard<mutex> lock(mtx);
+  if(idleTimeout != 0 && !compressor.joinable())
+    compressor = thread(&VariableStore::compressIdle, this);
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::setMemoryLimit(size_t bytes){
+  memoryLimit = bytes;
+}
+//---------------------------------------------------------------------------------------
+size_t VariableStore::getMemoryLimit(){
+  return memoryLimit;
+}
+//---------------------------------------------------------------------------------------
+size_t VariableStore::getMemoryUsed(){
+  return memoryUsed;
+}
+//---------------------------------------------------------------------------------------
+size_t VariableStore::newVersion(){
+  return ++lastVersion;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::applyLimit(){
+  lock_guard<mutex> lock(mtx);
+  limit(NULL);
+}
+//---------------------------------------------------------------------------------------
+VariableStore::Info VariableStore::describe(const Matrix & m, const char * state){
+  return Info{m.getRows(), m.getCols(), m.countNonZeros(), m.getMemory(), m.getStorageName(), state};
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::account(Variable & v){
+  size_t bytes = v.matrix ? v.matrix->getMemory() : v.packed ? v.packed->getSize() : 0;
+  memoryUsed += bytes;
+  memoryUsed -= v.bytes;
+  v.bytes = bytes;
+}
+//---------------------------------------------------------------------------------------
+bool VariableStore::spill(Variable & v) const{
+  if(scratch < 0){
+    const char * dir = getenv("TMPDIR");
+    string path = string(dir && *dir ? dir : "/tmp") + "/hruskraj-XXXXXX";
+    scratch = mkstemp(&path[0]);
+    if(scratch < 0)
+      return false;
+    //file is removed when it is closed
+    unlink(path.c_str());
+  }
+  Info info = v.matrix ? describe(*v.matrix, "spilled") : v.info;
+  info.state = "spilled";
+  string bytes = (v.packed ? *v.packed : CompressedMatrix(*v.matrix)).serialize();
+  for(size_t done = 0; done < bytes.size(); ){
+    ssize_t written = pwrite(scratch, bytes.data() + done, bytes.size() - done, scratchSize + done);
+    if(written <= 0)
+      return false;
+    done += written;
+  }
+  v.offset = scratchSize;
+  v.spilled = bytes.size();
+  v.info = info;
+  //memory of the matrix is not counted any more, so the cache must not keep it
+  if(v.matrix)
+    ResultCache::getInstance().release(v.matrix.get());
+  v.matrix.reset();
+  v.packed.reset();
+  account(v);
+  scratchSize += bytes.size();
+  ++spilledCount;
+  return true;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::load(Variable & v) const{
+  size_t page = sysconf(_SC_PAGESIZE), start = v.offset / page * page, shift = v.offset - start;
+  void * mapped = mmap(NULL, shift + v.spilled, PROT_READ, MAP_PRIVATE, scratch, start);
+  if(mapped != MAP_FAILED){
+    v.packed = make_shared<CompressedMatrix>(static_cast<const char *>(mapped) + shift, v.spilled);
+    munmap(mapped, shift + v.spilled);
+  }
+  else{
+    string bytes(v.spilled, 0);
+    for(size_t done = 0; done < bytes.size(); ){
+      ssize_t got = pread(scratch, &bytes[done], bytes.size() - done, v.offset + done);
+      if(got <= 0)
+        throw MatrixException("Spilled matrix cannot be read!");
+      done += got;
+    }
+    v.packed = make_shared<CompressedMatrix>(bytes.data(), bytes.size());
+  }
+  v.spilled = 0;
+  //space of spilled matrices is reused when none is left
+  if(--spilledCount == 0 && ftruncate(scratch, 0) == 0)
+    scratchSize = 0;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::limit(const Variable * keep) const{
+  while(memoryLimit != 0 && memoryUsed > memoryLimit){
+    Variable * oldest = NULL;
+    for(auto & x : vars){
+      Variable & v = x.second;
+      if(&v == keep || v.bytes == 0 || (v.matrix && v.matrix->isBinaryField()))
+        continue;
+      if(oldest == NULL || v.used < oldest->used)
+        oldest = &v;
+    }
+    if(oldest == NULL || !spill(*oldest))
+      return;
+  }
+}
+//---------------------------------------------------------------------------------------
+const shared_ptr<const Matrix> & VariableStore::use(Variable & v) const{
+  if(!v.matrix){
+    if(v.spilled)
+      load(v);
+    v.matrix = make_shared<Matrix>(v.packed->expand());
+    v.packed.reset();
+    account(v);
+    limit(&v);
+  }
+  v.used = chrono::steady_clock::now();
+  return v.matrix;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::compressIdle(){
+  struct Candidate{
+    string name;
+    shared_ptr<const Matrix> matrix;
+    size_t version;
+    chrono::steady_clock::time_point used;
+  };
+  unique_lock<mutex> lock(mtx);
+  while(!cv.wait_for(lock, chrono::seconds(1), [this]{ return stop; })){
+    size_t timeout = idleTimeout;
+    if(timeout == 0)
+      continue;
+    auto now = chrono::steady_clock::now();
+    vector<Candidate> idle;
+    for(const auto & x : vars){
+      const Variable & v = x.second;
+      if(!v.matrix || v.kept == v.version || v.matrix->isBinaryField() || now - v.used < chrono::seconds(timeout))
+        continue;
+      //results of the cache would keep the matrix in memory
+      ResultCache::getInstance().release(v.matrix.get());
+      //matrix held by somebody else would not be freed, it is tried again later
+      if(v.matrix.use_count() == 1)
+        idle.push_back(Candidate{x.first, v.matrix, v.version, v.used});
+    }
+    for(Candidate & x : idle){
+      if(stop)
+        break;
+      lock.unlock();
+      shared_ptr<const CompressedMatrix> packed = make_shared<CompressedMatrix>(*x.matrix);
+      Info info = describe(*x.matrix, "compressed");
+      shared_ptr<const Matrix> old;
+      lock.lock();
+      const auto & it = vars.find(x.name);
+      //variable could be changed or read while the lock was not held
+      if(it == vars.end() || it->second.matrix != x.matrix || it->second.version != x.version
+         || it->second.used != x.used || it->second.matrix.use_count() > 2)
+        continue;
+      if(packed->getSize() * 4 > x.matrix->getMemory() * 3){
+        it->second.kept = x.version;
+        continue;
+      }
+      it->second.packed = packed;
+      it->second.info = info;
+      old.swap(it->second.matrix);
+      account(it->second);
+      x.matrix.reset();
+      //old matrix is freed outside of the lock
+      lock.unlock();
+      old.reset();
+      lock.lock();
+    }
+  }
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> VariableStore::find(const string & var) const{
+  size_t version;
+  return find(var, version);
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> VariableStore::find(const string & var, size_t & version) const{
+  lock_guard<mutex> lock(mtx);
+  const auto & it = vars.find(var);
+  if(it == vars.cend())
+    return shared_ptr<const Matrix>();
+  version = it->second.version;
+  return use(it->second);
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::store(const string & var, const shared_ptr<const Matrix> & m){
+  shared_ptr<const Matrix> old = m;
+  {
+    lock_guard<mutex> lock(mtx);
+    Variable & v = vars[var];
+    v.matrix.swap(old);
+    v.packed.reset();
+    if(v.spilled){
+      v.spilled = 0;
+      --spilledCount;
+    }
+    v.version = ++lastVersion;
+    v.used = chrono::steady_clock::now();
+    account(v);
+    limit(&v);
+  }
+  //old matrix is freed here, outside of the lock
+  startCompressor();
+}
+//---------------------------------------------------------------------------------------
+shared_ptr<const Matrix> VariableStore::update(const string & var, const function<void(Matrix &)> & change){
+  lock_guard<mutex> lock(mtx);
+  const auto & it = vars.find(var);
+  if(it == vars.end())
+    return shared_ptr<const Matrix>();
+  use(it->second);
+  //no new snapshot can be taken while the lock is held
+  if(it->second.matrix.use_count() > 1)
+    it->second.matrix = make_shared<Matrix>(*it->second.matrix);
+  //stored matrices are made as non-const objects, they are only shared as const
+  change(const_cast<Matrix &>(*it->second.matrix));
+  it->second.version = ++lastVersion;
+  account(it->second);
+  limit(&it->second);
+  return it->second.matrix;
+}
+//---------------------------------------------------------------------------------------
+bool VariableStore::erase(const string & var){
+  shared_ptr<const Matrix> old;
+  {
+    lock_guard<mutex> lock(mtx);
+    const auto & it = vars.find(var);
+    if(it == vars.end())
+      return false;
+    old.swap(it->second.matrix);
+    it->second.packed.reset();
+    if(it->second.spilled)
+      --spilledCount;
+    account(it->second);
+    vars.erase(it);
+  }
+  return true;
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::getNames(set<string> & names) const{
+  lock_guard<mutex> lock(mtx);
+  for(const auto & x : vars)
+    names.insert(x.first);
+}
+//---------------------------------------------------------------------------------------
+void VariableStore::getInfo(map<string, Info> & info) const{
+  lock_guard<mutex> lock(mtx);
+  for(const auto & x : vars){
+    const Variable & v = x.second;
+    Info & out = info[x.first] = v.matrix ? describe(*v.matrix, "memory") : v.info;
+    out.bytes = v.bytes;
+  }
+}
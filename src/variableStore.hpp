@@ -0,0 +1,223 @@
+#ifndef VARIABLESTORE_HPP
+#define VARIABLESTORE_HPP
+
+#include <string>
+#include <map>
+#include <set>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include "matrix.hpp"
+#include "compressedMatrix.hpp"
+
+/**
+  * @brief Named matrices which can be used by several threads.
+  *
+  * Stored matrices are never changed. Reader gets its own reference to the current
+  * matrix (a snapshot) and writer replaces the reference, so the lock is held only
+  * while the map is searched. A long computation on a snapshot does not block other
+  * readers nor writers of the same variable. Every write gives the variable a new
+  * version, versions are unique in the whole program.
+  *
+  * If idle timeout is set, a background thread of the store compresses matrices which
+  * were not used for that time to CompressedMatrix. Compressed matrix is expanded by
+  * the next access, its version stays the same.
+  *
+  * Bytes of all stored matrices of all stores are counted. If they exceed the memory
+  * limit, the least recently used matrices of the store which grew are compressed and
+  * spilled to its scratch file, an unlinked temporary file. Results of ResultCache which
+  * hold a spilled matrix are dropped, so its memory is really freed. Spilled matrix is
+  * mapped back and expanded by the next access.
+  */
+class VariableStore{
+  public:
+    /**
+      * @brief Description of variable for listing.
+      */
+    struct Info{
+      size_t rows, ///< Number of rows.
+             cols, ///< Number of columns.
+             nonZeros, ///< Number of non-zero elements.
+             bytes; ///< Bytes counted for the variable.
+      std::string storage; ///< Storage of matrix when it was expanded.
+      std::string state; ///< memory, compressed or spilled.
+    };
+  private:
+    /**
+      * @brief Stored variable.
+      */
+    struct Variable{
+      std::shared_ptr<const Matrix> matrix; ///< Current matrix, empty if it is compressed or spilled.
+      std::shared_ptr<const CompressedMatrix> packed; ///< Compressed matrix.
+      size_t version; ///< Version of matrix.
+      size_t kept = 0; ///< Version which did not pay off to compress.
+      size_t bytes = 0; ///< Bytes counted in memoryUsed.
+      size_t offset = 0, ///< Position of spilled matrix in scratch file.
+             spilled = 0; ///< Bytes of spilled matrix, 0 if it is not spilled.
+      Info info; ///< Description kept while matrix is not expanded.
+      std::chrono::steady_clock::time_point used; ///< Time of the last access.
+    };
+    ///Stored variables, readers expand compressed matrices.
+    mutable std::map<std::string, Variable> vars;
+    mutable std::mutex mtx; ///< Guards vars and stop.
+    std::condition_variable cv; ///< Signals stop to compressing thread.
+    std::thread compressor; ///< Thread which compresses idle matrices.
+    bool stop = false; ///< Whether compressing thread should finish.
+    static std::atomic<size_t> lastVersion; ///< Last version given to a variable.
+    /**
+      * @brief Seconds after which unused matrix is compressed, 0 turns compression off.
+      * @sa setIdleTimeout
+      */
+    static std::atomic<size_t> idleTimeout;
+    static std::atomic<size_t> memoryLimit; ///< Limit of memoryUsed, 0 means no limit.
+    static std::atomic<size_t> memoryUsed; ///< Bytes of matrices of all stores.
+    mutable int scratch = -1; ///< Scratch file for spilled matrices.
+    mutable size_t scratchSize = 0; ///< End of the last spilled matrix.
+    mutable size_t spilledCount = 0; ///< Number of spilled matrices.
+
+    /**
+      * @brief Describes matrix.
+      * @param m matrix
+      * @param state state of variable
+      * @return description
+      */
+    static Info describe(const Matrix & m, const char * state);
+    /**
+      * @brief Recounts bytes of variable in memoryUsed.
+      * @param v variable
+      */
+    static void account(Variable & v);
+    /**
+      * @brief Writes matrix of variable to scratch file and frees it.
+      * Lock must be held.
+      * @param v variable
+      * @return true if matrix was spilled otherwise false
+      */
+    bool spill(Variable & v) const;
+    /**
+      * @brief Reads spilled matrix of variable.
+      * Scratch file is mapped to memory if possible, otherwise it is read. Lock must
+      * be held.
+      * @throw MatrixException if scratch file cannot be read
+      * @param v variable
+      */
+    void load(Variable & v) const;
+    /**
+      * @brief Spills least recently used matrices while memory limit is exceeded.
+      * Lock must be held.
+      * @param keep variable which is not spilled or NULL
+      */
+    void limit(const Variable * keep) const;
+
+    /**
+      * @brief Returns current matrix of variable and marks it as used.
+      * Compressed or spilled matrix is expanded. Lock must be held.
+      * @param v variable
+      * @return matrix
+      */
+    const std::shared_ptr<const Matrix> & use(Variable & v) const;
+    /**
+      * @brief Main loop of compressing thread.
+      * Idle matrices are compressed without the lock and the result is kept only if the
+      * variable was not used meanwhile and if it saves at least a quarter of memory.
+      */
+    void compressIdle();
+  public:
+    VariableStore() = default;
+    /**
+      * @brief Stops compressing thread, closes scratch file and uncounts matrices.
+      */
+    ~VariableStore();
+    VariableStore(const VariableStore & other) = delete;
+    VariableStore & operator =(const VariableStore & other) = delete;
+
+    /**
+      * @brief Sets time after which unused matrices are compressed in all stores.
+      * @param seconds idle time, 0 turns compression off
+      */
+    static void setIdleTimeout(size_t seconds);
+    /**
+      * @brief Starts compressing thread of this store if compression is on.
+      * Thread is started by the first store or find after the idle timeout is set, so
+      * this is needed only for stores which are not used anymore.
+      */
+    void startCompressor();
+    /**
+      * @brief Sets limit of bytes of matrices of all stores.
+      * @param bytes limit, 0 means no limit
+      */
+    static void setMemoryLimit(size_t bytes);
+    /**
+      * @brief Returns limit of bytes of matrices of all stores.
+      * @return limit, 0 means no limit
+      */
+    static size_t getMemoryLimit();
+    /**
+      * @brief Returns bytes of matrices of all stores.
+      * @return bytes
+      */
+    static size_t getMemoryUsed();
+    /**
+      * @brief Gives a new version which no variable has.
+      * @return version
+      */
+    static size_t newVersion();
+    /**
+      * @brief Spills matrices of this store until the memory limit is kept.
+      */
+    void applyLimit();
+
+    /**
+      * @brief Finds variable.
+      * @param var variable name
+      * @return snapshot of variable or empty pointer if there is no such variable
+      */
+    std::shared_ptr<const Matrix> find(const std::string & var) const;
+    /**
+      * @brief Finds variable and its version.
+      * @param var variable name
+      * @param[out] version version of variable
+      * @return snapshot of variable or empty pointer if there is no such variable
+      */
+    std::shared_ptr<const Matrix> find(const std::string & var, size_t & version) const;
+    /**
+      * @brief Stores matrix to variable.
+      * @param var variable name
+      * @param m matrix
+      */
+    void store(const std::string & var, const std::shared_ptr<const Matrix> & m);
+    /**
+      * @brief Changes matrix of variable in place and gives it a new version.
+      * If somebody holds a snapshot of the matrix, the change is made on a copy which
+      * shares storage with the snapshot, so the snapshot stays unchanged. Change is made
+      * under the lock, it should take time comparable to a copy of the matrix.
+      * @throw MatrixException
+      * @param var variable name
+      * @param change change of matrix
+      * @return snapshot of changed variable or empty pointer if there is no such variable
+      */
+    std::shared_ptr<const Matrix> update(const std::string & var, const std::function<void(Matrix &)> & change);
+    /**
+      * @brief Deletes variable.
+      * @param var variable name
+      * @return true if variable was deleted otherwise false
+      */
+    bool erase(const std::string & var);
+    /**
+      * @brief Adds names of all variables to <i>names</i>.
+      * @param[in, out] names names
+      */
+    void getNames(std::set<std::string> & names) const;
+    /**
+      * @brief Adds descriptions of all variables to <i>info</i>.
+      * Matrices are not expanded.
+      * @param[in, out] info descriptions by names
+      */
+    void getInfo(std::map<std::string, Info> & info) const;
+};
+
+#endif /* VARIABLESTORE_HPP */